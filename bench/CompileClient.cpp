@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/program_options.hpp>
+
+#include "CompileProtocol.h"
+namespace po = boost::program_options;
+
+///Round trip of a single request as the client saw it
+struct RequestTiming
+{
+    double milliseconds = 0;
+    double serverMilliseconds = 0;
+};
+
+bool readSource(const std::filesystem::path& file, std::string& source);
+double percentile(std::vector<double>& values, double fraction);
+
+int main(int argc, char** argv)
+{
+    po::options_description desc("Allowed options");
+    desc.add_options()
+    ("help,h", "produce help message")
+    ("socket", po::value<std::string>(),"Socket of a running shaderfax serve")
+    ("module,m", po::value<std::vector<std::string>>()->composing(),"Module to compile, relative to the server's root, may be repeated or given without the option")
+    ("define,D", po::value<std::vector<std::string>>()->composing(),"Macro NAME=VALUE sent with every request, may be repeated")
+    ("inline", po::value<std::string>(),"Send the source of every module from this folder instead of letting the server read it")
+    ("output,o", po::value<std::string>(),"Folder the returned .cshdr files are written to")
+    ("repeat", po::value<size_t>()->default_value(1),"Times every connection requests every module")
+    ("connections", po::value<size_t>()->default_value(1),"Connections sending requests at the same time")
+    ;
+    po::positional_options_description positional;
+    positional.add("module",-1);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc,argv).options(desc).positional(positional).run(),vm);
+    if (vm.count("help") || !vm.count("socket") || !vm.count("module"))
+    {
+        std::cout << desc << std::endl;
+        return vm.count("help") ? 0 : EXIT_FAILURE;
+    }
+
+    std::filesystem::path socket = vm["socket"].as<std::string>();
+    std::vector<CompileRequest> requests;
+    for (auto& module: vm["module"].as<std::vector<std::string>>())
+    {
+        CompileRequest request{.path = module};
+        if (vm.count("inline") && !readSource(std::filesystem::path(vm["inline"].as<std::string>())/module,request.source))
+        {
+            std::cerr<< "Unable to read "<<module<<"\n";
+            return EXIT_FAILURE;
+        }
+        if (vm.count("define"))
+        {
+            for (auto& define: vm["define"].as<std::vector<std::string>>())
+            {
+                auto equals = define.find('=');
+                request.macros.push_back({.name = define.substr(0,equals),.value = equals == std::string::npos ? "1" : define.substr(equals + 1)});
+            }
+        }
+        requests.push_back(std::move(request));
+    }
+    auto repeat = std::max<size_t>(1,vm["repeat"].as<size_t>());
+    auto connections = std::max<size_t>(1,vm["connections"].as<size_t>());
+
+    std::mutex mutex;
+    std::vector<RequestTiming> timings;
+    std::atomic<bool> failed = false;
+    auto client = [&]()
+    {
+        int connection = connectToSocket(socket);
+        if (connection < 0)
+        {
+            std::lock_guard lock(mutex);
+            std::cerr<< "Unable to connect to "<<socket<<"\n";
+            failed = true;
+            return;
+        }
+        CompileResponse response;
+        for (auto i=0; i<repeat && !failed; ++i)
+        {
+            for (auto& request: requests)
+            {
+                auto start = std::chrono::steady_clock::now();
+                if (!sendRequest(connection,request) || !receiveResponse(connection,response))
+                {
+                    std::lock_guard lock(mutex);
+                    std::cerr<< "Connection to "<<socket<<" closed\n";
+                    failed = true;
+                    break;
+                }
+                RequestTiming timing{.milliseconds = std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now() - start).count(),
+                                     .serverMilliseconds = response.microseconds/1000.0};
+                std::lock_guard lock(mutex);
+                timings.push_back(timing);
+                std::cout << request.path<<(response.success ? "" : " failed")<<" "<<response.file.size()<<" bytes in "
+                          <<timing.milliseconds<<"ms, server "<<timing.serverMilliseconds<<"ms\n"<<response.diagnostics;
+                if (!response.success)
+                {
+                    failed = true;
+                }
+                else if (vm.count("output") && !response.file.empty())
+                {
+                    auto file = std::filesystem::path(vm["output"].as<std::string>())/std::filesystem::path(request.path).replace_extension(".cshdr");
+                    std::filesystem::create_directories(file.parent_path());
+                    std::ofstream(file,std::ios::binary).write(response.file.data(),response.file.size());
+                }
+            }
+        }
+        closeSocket(connection);
+    };
+    std::vector<std::thread> threads;
+    for (auto i=0; i<connections; ++i)
+    {
+        threads.emplace_back(client);
+    }
+    for (auto& thread: threads)
+    {
+        thread.join();
+    }
+
+    if (timings.size() > 1)
+    {
+        std::vector<double> roundTrips;
+        std::vector<double> serverTimes;
+        for (auto& timing: timings)
+        {
+            roundTrips.push_back(timing.milliseconds);
+            serverTimes.push_back(timing.serverMilliseconds);
+        }
+        std::cout << timings.size()<<" requests, round trip median "<<percentile(roundTrips,0.5)<<"ms p95 "<<percentile(roundTrips,0.95)
+                  <<"ms max "<<percentile(roundTrips,1)<<"ms, server median "<<percentile(serverTimes,0.5)<<"ms\n";
+    }
+    return failed ? EXIT_FAILURE : 0;
+}
+
+bool readSource(const std::filesystem::path& file, std::string& source)
+{
+    std::ifstream inFile(file,std::ios::binary);
+    if (!inFile)
+    {
+        return false;
+    }
+    std::ostringstream text;
+    text << inFile.rdbuf();
+    source = text.str();
+    return true;
+}
+
+double percentile(std::vector<double>& values, double fraction)
+{
+    std::sort(values.begin(),values.end());
+    return values[std::min(values.size() - 1,(size_t)(fraction*(values.size() - 1) + 0.5))];
+}
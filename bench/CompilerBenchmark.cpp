@@ -0,0 +1,371 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>
+
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Json.h"
+namespace po = boost::program_options;
+
+extern char** environ;
+
+///Shape of a generated corpus, the same options and seed always produce the same files
+struct CorpusOptions
+{
+    size_t modules = 0;
+    ///Length of the chain of library modules every shader imports
+    size_t importDepth = 0;
+    size_t parameterBlocks = 0;
+    ///Vertex and fragment entry points of every module
+    size_t entryPoints = 0;
+    ///OutputColorTarget attributes of every fragment entry point
+    size_t colorTargets = 0;
+    uint32_t seed = 0;
+};
+
+///Fastest of several clean builds of a corpus
+struct RunResult
+{
+    std::chrono::nanoseconds time = std::chrono::nanoseconds::max();
+    ///Largest resident set of any run, in kilobytes
+    long peakRss = 0;
+    size_t outputSize = 0;
+    ///Time summed over every thread per profiler phase, of the fastest run
+    std::map<std::string,std::chrono::nanoseconds> phases;
+};
+
+bool writeCorpus(const std::filesystem::path& directory, const CorpusOptions& options);
+bool runShaderfax(const std::vector<std::string>& arguments, long& peakRss);
+bool readPhases(const std::filesystem::path& traceFile, std::map<std::string,std::chrono::nanoseconds>& phases);
+size_t directorySize(const std::filesystem::path& directory);
+void writeResult(std::ostream& out, const CorpusOptions& options, size_t shaders, const RunResult& result);
+
+int main(int argc, char** argv)
+{
+    po::options_description desc("Allowed options");
+    desc.add_options()
+    ("help,h", "produce help message")
+    ("shaderfax", po::value<std::string>()->default_value(SHADERFAX_EXECUTABLE),"Shaderfax executable to benchmark")
+    ("directory", po::value<std::string>()->default_value((std::filesystem::temp_directory_path()/"shaderfax-bench").string()),"Folder the corpora and outputs are written to")
+    ("modules", po::value<std::vector<size_t>>()->multitoken()->default_value({50,200,1000},"50 200 1000"),"Corpus sizes to benchmark, in shader modules")
+    ("import-depth", po::value<size_t>()->default_value(3),"Length of the chain of library modules every shader imports")
+    ("parameter-blocks", po::value<size_t>()->default_value(2),"ParameterBlocks of every module")
+    ("entry-points", po::value<size_t>()->default_value(1),"Vertex and fragment entry points of every module")
+    ("color-targets", po::value<size_t>()->default_value(1),"OutputColorTarget attributes of every fragment entry point")
+    ("seed", po::value<uint32_t>()->default_value(1234),"Seed of the corpus generator")
+    ("jobs,j", po::value<unsigned int>()->default_value(0),"Jobs passed to Shaderfax, 0 uses every available core")
+    ("format", po::value<std::string>()->default_value("v2"),"Format passed to Shaderfax")
+    ("iterations", po::value<size_t>()->default_value(3),"Clean builds of every corpus, the fastest one is reported")
+    ("output", po::value<std::string>(),"Write the results to a JSON file instead of standard output")
+    ("keep", "Leave the corpora and outputs on disk")
+    ;
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc,argv,desc),vm);
+    if (vm.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    std::filesystem::path directory = vm["directory"].as<std::string>();
+    auto shaderfax = vm["shaderfax"].as<std::string>();
+    auto iterations = std::max<size_t>(1,vm["iterations"].as<size_t>());
+    CorpusOptions options{
+        .importDepth = vm["import-depth"].as<size_t>(),
+        .parameterBlocks = vm["parameter-blocks"].as<size_t>(),
+        .entryPoints = std::max<size_t>(1,vm["entry-points"].as<size_t>()),
+        .colorTargets = std::max<size_t>(1,vm["color-targets"].as<size_t>()),
+        .seed = vm["seed"].as<uint32_t>()
+    };
+
+    std::ostringstream results;
+    results << "{\"shaderfax\":";
+    writeJsonString(results,shaderfax);
+    results << ",\"jobs\":" << vm["jobs"].as<unsigned int>() << ",\"format\":";
+    writeJsonString(results,vm["format"].as<std::string>());
+    results << ",\"iterations\":" << iterations << ",\"runs\":[\n";
+    auto sizes = vm["modules"].as<std::vector<size_t>>();
+    for (auto i=0; i<sizes.size(); ++i)
+    {
+        options.modules = sizes[i];
+        auto corpus = directory/("corpus-"+std::to_string(options.modules));
+        auto output = directory/("output-"+std::to_string(options.modules));
+        auto trace = directory/("trace-"+std::to_string(options.modules)+".json");
+        std::filesystem::remove_all(corpus);
+        if (!writeCorpus(corpus,options))
+        {
+            std::cerr<< "Unable to write corpus to "<<corpus<<"\n";
+            return EXIT_FAILURE;
+        }
+
+        RunResult result;
+        for (auto j=0; j<iterations; ++j)
+        {
+            //every run is a clean build, --rebuild ignores the manifest and the output is written from scratch
+            std::filesystem::remove_all(output);
+            long peakRss = 0;
+            auto start = std::chrono::steady_clock::now();
+            if (!runShaderfax({shaderfax,"--root",corpus.string(),"--output",output.string(),"--jobs",std::to_string(vm["jobs"].as<unsigned int>()),
+                               "--format",vm["format"].as<std::string>(),"--rebuild","--profile",trace.string()},peakRss))
+            {
+                std::cerr<< "Shaderfax failed to build "<<corpus<<"\n";
+                return EXIT_FAILURE;
+            }
+            auto time = std::chrono::steady_clock::now() - start;
+            result.peakRss = std::max(result.peakRss,peakRss);
+            if (time < result.time)
+            {
+                result.time = time;
+                result.phases.clear();
+                if (!readPhases(trace,result.phases))
+                {
+                    std::cerr<< "Unable to read profile "<<trace<<"\n";
+                    return EXIT_FAILURE;
+                }
+                result.outputSize = directorySize(output);
+            }
+        }
+
+        size_t shaders = options.modules*options.entryPoints*2;
+        std::cerr<< options.modules<<" modules: "<<std::chrono::duration<double,std::milli>(result.time).count()<<" ms, "
+                 <<shaders / std::chrono::duration<double>(result.time).count()<<" shaders/s, peak RSS "<<result.peakRss / 1024<<" MB\n";
+        writeResult(results,options,shaders,result);
+        results << (i + 1 < sizes.size() ? ",\n" : "\n");
+    }
+    results << "]}\n";
+
+    if (vm.count("output"))
+    {
+        std::ofstream out(vm["output"].as<std::string>(),std::ios::trunc);
+        out << results.str();
+        if (!out)
+        {
+            std::cerr<< "Unable to write "<<vm["output"].as<std::string>()<<"\n";
+            return EXIT_FAILURE;
+        }
+    }
+    else
+    {
+        std::cout << results.str();
+    }
+
+    if (!vm.count("keep"))
+    {
+        std::filesystem::remove_all(directory);
+    }
+    return 0;
+}
+
+///Every shader imports lib/types and the head of a chain of lib/common modules, each importing the next one. Modules are
+///spread over subfolders so the walk and the output tree look like a real project
+bool writeCorpus(const std::filesystem::path& directory, const CorpusOptions& options)
+{
+    std::mt19937 random(options.seed);
+    auto writeFile = [&](const std::filesystem::path& file, const std::string& text)
+    {
+        std::filesystem::create_directories(file.parent_path());
+        std::ofstream out(file, std::ios::trunc);
+        out << text;
+        return (bool)out;
+    };
+
+    std::ostringstream types;
+    types << "[__AttributeUsage(_AttributeTargets.Function)]\n"
+          << "struct OutputColorTargetAttribute\n{\n    int index;\n    int format;\n};\n\n"
+          << "struct Vertex3D\n{\n    float3 position;\n};\n\n"
+          << "struct UVCoordinates\n{\n    float2 uv;\n};\n";
+    if (!writeFile(directory/"lib"/"types.slang",types.str()))
+    {
+        return false;
+    }
+    for (auto depth=0; depth<options.importDepth; ++depth)
+    {
+        std::ostringstream common;
+        if (depth + 1 < options.importDepth)
+        {
+            common << "import lib.common" << depth + 1 << ";\n\n";
+        }
+        common << "public float4 shade" << depth << "(float4 value)\n{\n"
+               << "    value = value * " << (random() % 100) / 10.0f + 1.0f << " + float4(" << (random() % 100) / 100.0f << ");\n";
+        if (depth + 1 < options.importDepth)
+        {
+            common << "    value = shade" << depth + 1 << "(value.yzwx);\n";
+        }
+        common << "    return value;\n}\n";
+        if (!writeFile(directory/"lib"/("common"+std::to_string(depth)+".slang"),common.str()))
+        {
+            return false;
+        }
+    }
+
+    //formats the fragment stage can write, indices of TexelFormat
+    const int colorFormats[] = {1,7,8,16,18,19,20};
+    for (auto i=0; i<options.modules; ++i)
+    {
+        std::ostringstream module;
+        module << "import lib.types;\n";
+        if (options.importDepth > 0)
+        {
+            module << "import lib.common0;\n";
+        }
+        module << "\n";
+        for (auto j=0; j<options.parameterBlocks; ++j)
+        {
+            module << "struct Material" << j << "\n{\n    float4 color;\n    float roughness;\n    Texture2D albedo;\n    SamplerState linearSampler;\n"
+                   << "    StructuredBuffer<float4> instances;\n};\n"
+                   << "ParameterBlock<Material" << j << "> material" << j << ";\n\n";
+        }
+        module << "struct VertexOutput\n{\n    float4 position : SV_Position;\n    float2 uv : TEXCOORD0;\n};\n\n"
+               << "struct FragmentOutput\n{\n";
+        for (auto j=0; j<options.colorTargets; ++j)
+        {
+            module << "    float4 target" << j << " : SV_Target" << j << ";\n";
+        }
+        module << "};\n\n";
+
+        for (auto j=0; j<options.entryPoints; ++j)
+        {
+            module << "[shader(\"vertex\")]\nVertexOutput vertex" << j << "(Vertex3D vertex, UVCoordinates uv, uint instance : SV_InstanceID)\n{\n"
+                   << "    float4 position = float4(vertex.position, 1.0);\n";
+            for (auto k=0; k<options.parameterBlocks; ++k)
+            {
+                module << "    position += material" << k << ".instances[instance] * " << (random() % 100) / 100.0f << ";\n";
+            }
+            if (options.importDepth > 0)
+            {
+                module << "    position = shade0(position);\n";
+            }
+            module << "    VertexOutput output;\n    output.position = position;\n    output.uv = uv.uv;\n    return output;\n}\n\n";
+
+            module << "[shader(\"fragment\")]\n";
+            for (auto k=0; k<options.colorTargets; ++k)
+            {
+                module << "[OutputColorTarget(" << k << ", " << colorFormats[random() % std::size(colorFormats)] << ")]\n";
+            }
+            module << "FragmentOutput fragment" << j << "(VertexOutput input)\n{\n    float4 color = float4(" << (random() % 100) / 100.0f << ");\n";
+            for (auto k=0; k<options.parameterBlocks; ++k)
+            {
+                module << "    color = color * material" << k << ".albedo.Sample(material" << k << ".linearSampler, input.uv) + material" << k << ".color * material" << k << ".roughness;\n";
+            }
+            if (options.importDepth > 0)
+            {
+                module << "    color = shade0(color);\n";
+            }
+            module << "    FragmentOutput output;\n";
+            for (auto k=0; k<options.colorTargets; ++k)
+            {
+                module << "    output.target" << k << " = color" << (k > 0 ? ".yzwx" : "") << ";\n";
+            }
+            module << "    return output;\n}\n\n";
+        }
+        if (!writeFile(directory/("group"+std::to_string(i % 16))/("shader"+std::to_string(i)+".slang"),module.str()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+///Runs Shaderfax to completion with its output discarded, peakRss is the child's maximum resident set in kilobytes
+bool runShaderfax(const std::vector<std::string>& arguments, long& peakRss)
+{
+    std::vector<char*> argv;
+    for (auto& argument: arguments)
+    {
+        argv.push_back(const_cast<char*>(argument.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions,STDOUT_FILENO,"/dev/null",O_WRONLY,0);
+    pid_t pid = 0;
+    auto error = posix_spawn(&pid,argv[0],&actions,nullptr,argv.data(),environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (error != 0)
+    {
+        std::cerr<< "Unable to run "<<arguments[0]<<": "<<std::strerror(error)<<"\n";
+        return false;
+    }
+
+    int status = 0;
+    rusage usage{};
+    if (wait4(pid,&status,0,&usage) != pid)
+    {
+        return false;
+    }
+    peakRss = usage.ru_maxrss;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+///Sums the durations of a trace written by Profiler::writeTrace, which puts every event on its own line
+bool readPhases(const std::filesystem::path& traceFile, std::map<std::string,std::chrono::nanoseconds>& phases)
+{
+    std::ifstream in(traceFile);
+    if (!in.is_open())
+    {
+        return false;
+    }
+    std::string line;
+    while (std::getline(in,line))
+    {
+        auto category = line.find("\"cat\":\"");
+        auto duration = line.find("\"dur\":");
+        if (category == std::string::npos || duration == std::string::npos)
+        {
+            continue;
+        }
+        category += 7;
+        auto phase = line.substr(category,line.find('"',category) - category);
+        phases[phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double,std::micro>(std::stod(line.substr(duration + 6))));
+    }
+    return true;
+}
+
+size_t directorySize(const std::filesystem::path& directory)
+{
+    size_t size = 0;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(directory,error))
+    {
+        if (entry.is_regular_file())
+        {
+            size += entry.file_size();
+        }
+    }
+    return size;
+}
+
+void writeResult(std::ostream& out, const CorpusOptions& options, size_t shaders, const RunResult& result)
+{
+    auto seconds = std::chrono::duration<double>(result.time).count();
+    auto milliseconds = [](std::chrono::nanoseconds time){return std::chrono::duration<double,std::milli>(time).count();};
+    out << "{\"modules\":" << options.modules << ",\"importDepth\":" << options.importDepth << ",\"parameterBlocks\":" << options.parameterBlocks
+        << ",\"entryPoints\":" << options.entryPoints << ",\"colorTargets\":" << options.colorTargets << ",\"seed\":" << options.seed
+        << ",\"shaders\":" << shaders << ",\"wallMs\":" << milliseconds(result.time) << ",\"shadersPerSecond\":" << shaders / seconds
+        << ",\"outputBytes\":" << result.outputSize << ",\"outputMBPerSecond\":" << result.outputSize / seconds / (1024*1024)
+        << ",\"peakRssKB\":" << result.peakRss << ",\"phasesMs\":{";
+    bool first = true;
+    for (auto& [phase,time]: result.phases)
+    {
+        out << (first ? "" : ",");
+        writeJsonString(out,phase);
+        out << ":" << milliseconds(time);
+        first = false;
+    }
+    out << "}}";
+}
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>
+
+#include "ShaderCompiler.h"
+#include "ShaderFileWriter.h"
+namespace po = boost::program_options;
+
+///Link and code generation time and output size of every module under a folder in one link mode
+struct LinkResult
+{
+    std::chrono::nanoseconds time{0};
+    size_t stages = 0;
+    size_t outputSize = 0;
+};
+
+bool measure(const std::filesystem::path& root, const std::vector<std::filesystem::path>& modulePaths, LinkMode mode, size_t iterations, LinkResult& result);
+
+int main(int argc, char** argv)
+{
+    po::options_description desc("Allowed options");
+    desc.add_options()
+    ("help,h", "produce help message")
+    ("root,r", po::value<std::string>(),"Top level folder containing shader files")
+    ("iterations", po::value<size_t>()->default_value(5),"Compiles of every module, the fastest one is reported")
+    ;
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc,argv,desc),vm);
+    if (vm.count("help") || !vm.count("root"))
+    {
+        std::cout << desc << std::endl;
+        return vm.count("help") ? 0 : EXIT_FAILURE;
+    }
+
+    std::filesystem::path root = vm["root"].as<std::string>();
+    std::vector<std::filesystem::path> modulePaths;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(root))
+    {
+        if (entry.is_regular_file() && entry.path().extension() == ".slang")
+        {
+            modulePaths.push_back(std::filesystem::relative(entry.path(),root));
+        }
+    }
+    std::sort(modulePaths.begin(),modulePaths.end());
+    auto iterations = std::max<size_t>(1,vm["iterations"].as<size_t>());
+
+    for (auto [mode,name]: {std::pair{LinkMode::SEPARATE,"separate"},std::pair{LinkMode::COMPOSITE,"composite"},std::pair{LinkMode::SHARED,"shared"}})
+    {
+        LinkResult result;
+        if (!measure(root,modulePaths,mode,iterations,result))
+        {
+            return EXIT_FAILURE;
+        }
+        std::cout<< name<<": "<<result.stages<<" stages, link and code generation "
+                 <<std::chrono::duration<double,std::milli>(result.time).count()<<" ms, "
+                 <<result.outputSize<<" bytes of v2 output\n";
+    }
+    return 0;
+}
+
+///Modules are loaded outside the timed region, parsing and checking are the same in every mode
+bool measure(const std::filesystem::path& root, const std::vector<std::filesystem::path>& modulePaths, LinkMode mode, size_t iterations, LinkResult& result)
+{
+    ShaderCompiler compiler(root,{.link = mode});
+    result.time = std::chrono::nanoseconds::max();
+    for (auto i=0; i<iterations; ++i)
+    {
+        compiler.resetSession();
+        std::chrono::nanoseconds time{0};
+        size_t stages = 0;
+        size_t outputSize = 0;
+        for (auto& modulePath: modulePaths)
+        {
+            std::ostringstream errors;
+            slang::IModule* module = nullptr;
+            if (!compiler.loadModule(modulePath,module,errors))
+            {
+                std::cerr<< errors.str();
+                return false;
+            }
+            if (!module || module->getDefinedEntryPointCount() == 0)
+            {
+                continue;
+            }
+            ShaderFileData fileData;
+            auto start = std::chrono::steady_clock::now();
+            if (!compiler.compileModule(module,fileData,errors))
+            {
+                std::cerr<< errors.str();
+                return false;
+            }
+            time += std::chrono::steady_clock::now() - start;
+            stages += fileData.shaderOutData.size();
+            outputSize += ShaderFileWriter(fileData,ShaderFileFormat::V2).size();
+        }
+        result.time = std::min(result.time,time);
+        result.stages = stages;
+        result.outputSize = outputSize;
+    }
+    return true;
+}
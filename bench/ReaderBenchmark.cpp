@@ -0,0 +1,163 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>
+
+#include <shaderfax/Reader.h>
+
+#include "MemoryBlob.h"
+#include "ShaderFileWriter.h"
+namespace po = boost::program_options;
+
+///Options shaping the synthetic corpus
+struct CorpusOptions
+{
+    size_t files = 0;
+    size_t stages = 0;
+    size_t codeSize = 0;
+    size_t descriptors = 0;
+};
+
+std::filesystem::path corpusFile(const std::filesystem::path& directory, size_t index);
+bool writeCorpus(const std::filesystem::path& directory, const CorpusOptions& options, ShaderFileFormat format);
+uint64_t readCorpus(const std::filesystem::path& directory, size_t files, size_t& shaders);
+
+int main(int argc, char** argv)
+{
+    po::options_description desc("Allowed options");
+    desc.add_options()
+    ("help,h", "produce help message")
+    ("directory", po::value<std::string>()->default_value((std::filesystem::temp_directory_path()/"shaderfax-reader-bench").string()),"Folder the synthetic corpus is written to")
+    ("files", po::value<size_t>()->default_value(20000),"Number of .cshdr files in the corpus")
+    ("stages", po::value<size_t>()->default_value(2),"Stages per file")
+    ("code-size", po::value<size_t>()->default_value(8192),"Bytes of SPIR-V per stage")
+    ("descriptors", po::value<size_t>()->default_value(8),"Descriptors per file")
+    ("iterations", po::value<size_t>()->default_value(5),"Passes over the corpus, the fastest one is reported")
+    ("keep", "Leave the corpus on disk")
+    ;
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc,argv,desc),vm);
+    if (vm.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    std::filesystem::path directory = vm["directory"].as<std::string>();
+    CorpusOptions options{
+        .files = vm["files"].as<size_t>(),
+        .stages = vm["stages"].as<size_t>(),
+        .codeSize = vm["code-size"].as<size_t>() / sizeof(uint32_t) * sizeof(uint32_t),
+        .descriptors = vm["descriptors"].as<size_t>()
+    };
+    auto iterations = std::max<size_t>(1,vm["iterations"].as<size_t>());
+
+    for (auto [format,name]: {std::pair{ShaderFileFormat::V1,"v1"},std::pair{ShaderFileFormat::V2,"v2"}})
+    {
+        auto corpus = directory/name;
+        std::filesystem::remove_all(corpus);
+        if (!writeCorpus(corpus,options,format))
+        {
+            std::cerr<< "Unable to write corpus to "<<corpus<<"\n";
+            return EXIT_FAILURE;
+        }
+
+        std::chrono::nanoseconds best = std::chrono::nanoseconds::max();
+        size_t shaders = 0;
+        for (auto i=0; i<iterations; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            if (readCorpus(corpus,options.files,shaders) == 0)
+            {
+                std::cerr<< "Unable to read corpus "<<corpus<<"\n";
+                return EXIT_FAILURE;
+            }
+            best = std::min<std::chrono::nanoseconds>(best,std::chrono::steady_clock::now() - start);
+        }
+        std::cout<< name<<": "<<options.files<<" files, "<<shaders<<" shaders, "
+                 <<std::chrono::duration<double,std::milli>(best).count()<<" ms, "
+                 <<best.count()/options.files<<" ns per file, "
+                 <<best.count()/std::max<size_t>(1,shaders)<<" ns per shader\n";
+    }
+
+    if (!vm.count("keep"))
+    {
+        std::filesystem::remove_all(directory);
+    }
+    return 0;
+}
+
+std::filesystem::path corpusFile(const std::filesystem::path& directory, size_t index)
+{
+    return directory/(std::to_string(index % 64))/(std::to_string(index)+".cshdr");
+}
+
+bool writeCorpus(const std::filesystem::path& directory, const CorpusOptions& options, ShaderFileFormat format)
+{
+    const char* stageNames[] = {"vertex","fragment","compute","mesh","task","geometry"};
+    std::mt19937 random(1234);
+    for (auto i=0; i<options.files; ++i)
+    {
+        ShaderFileData fileData;
+        std::vector<Descriptor> descriptors;
+        for (auto j=0; j<options.descriptors; ++j)
+        {
+            descriptors.push_back({.name = "descriptor"+std::to_string(j),.type = (DescriptorType)(j % 10),.index = (size_t)j,.count = 1});
+        }
+        fileData.descriptorSets.push_back(DescriptorSet(0,std::move(descriptors)));
+        for (auto j=0; j<options.stages; ++j)
+        {
+            std::vector<char> code(options.codeSize);
+            std::generate(code.begin(),code.end(),[&](){return (char)random();});
+            fileData.shaderOutData.push_back({.stage = stageNames[j % std::size(stageNames)],.parameters = {"POSITION","NORMAL","UV"},.spirvCode = MemoryBlob::create(std::move(code))});
+        }
+        auto file = corpusFile(directory,i);
+        std::filesystem::create_directories(file.parent_path());
+        ShaderFileWriter writer(fileData,format);
+        if (writer.write(file) == WriteResult::FAILED)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+///Opens every file and touches all of its metadata and code, returns a checksum that is zero on failure
+uint64_t readCorpus(const std::filesystem::path& directory, size_t files, size_t& shaders)
+{
+    uint64_t checksum = 1;
+    shaders = 0;
+    for (auto i=0; i<files; ++i)
+    {
+        shaderfax::ShaderFile file;
+        if (!file.open(corpusFile(directory,i)))
+        {
+            return 0;
+        }
+        for (auto j=0; j<file.descriptorSetCount(); ++j)
+        {
+            auto descriptorSet = file.descriptorSet(j);
+            for (auto k=0; k<descriptorSet.size(); ++k)
+            {
+                auto descriptor = descriptorSet[k];
+                checksum += descriptor.name.size() + descriptor.binding + descriptor.type;
+            }
+        }
+        for (auto j=0; j<file.stageCount(); ++j)
+        {
+            auto stage = file.stage(j);
+            checksum += stage.stage.size() + stage.code.size() + (stage.code.empty() ? 0 : (uint8_t)stage.code.back());
+            for (auto k=0; k<stage.parameters.size(); ++k)
+            {
+                checksum += stage.parameters[k].size();
+            }
+            ++shaders;
+        }
+    }
+    return checksum;
+}
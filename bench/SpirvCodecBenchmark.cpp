@@ -0,0 +1,196 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <boost/program_options.hpp>
+
+#include <shaderfax/Reader.h>
+#include <shaderfax/SpirvCodec.h>
+namespace po = boost::program_options;
+
+void loadModules(const std::filesystem::path& directory, std::vector<std::vector<uint32_t>>& modules);
+void generateModules(size_t count, size_t instructions, std::vector<std::vector<uint32_t>>& modules);
+
+int main(int argc, char** argv)
+{
+    po::options_description desc("Allowed options");
+    desc.add_options()
+    ("help,h", "produce help message")
+    ("input,i", po::value<std::string>(),"Folder of .cshdr and .shpak files to take SPIR-V from, synthetic modules are used otherwise")
+    ("modules", po::value<size_t>()->default_value(2000),"Number of synthetic modules")
+    ("instructions", po::value<size_t>()->default_value(2000),"Instructions per synthetic module")
+    ("iterations", po::value<size_t>()->default_value(5),"Passes over the modules, the fastest one is reported")
+    ;
+
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc,argv,desc),vm);
+    if (vm.count("help"))
+    {
+        std::cout << desc << std::endl;
+        return 0;
+    }
+
+    std::vector<std::vector<uint32_t>> modules;
+    if (vm.count("input"))
+    {
+        loadModules(vm["input"].as<std::string>(),modules);
+    }
+    else
+    {
+        generateModules(vm["modules"].as<size_t>(),vm["instructions"].as<size_t>(),modules);
+    }
+    if (modules.empty())
+    {
+        std::cerr<< "No SPIR-V modules to compress\n";
+        return EXIT_FAILURE;
+    }
+    auto iterations = std::max<size_t>(1,vm["iterations"].as<size_t>());
+
+    std::vector<std::vector<char>> encoded(modules.size());
+    size_t rawSize = 0;
+    size_t encodedSize = 0;
+    auto bestEncode = std::chrono::nanoseconds::max();
+    for (auto i=0; i<iterations; ++i)
+    {
+        rawSize = 0;
+        encodedSize = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (auto j=0; j<modules.size(); ++j)
+        {
+            if (!shaderfax::encodeSpirv(modules[j],encoded[j]))
+            {
+                std::cerr<< "Module "<<j<<" is not valid SPIR-V\n";
+                return EXIT_FAILURE;
+            }
+            rawSize += modules[j].size()*sizeof(uint32_t);
+            encodedSize += encoded[j].size();
+        }
+        bestEncode = std::min<std::chrono::nanoseconds>(bestEncode,std::chrono::steady_clock::now() - start);
+    }
+
+    std::vector<uint32_t> decoded;
+    auto bestDecode = std::chrono::nanoseconds::max();
+    for (auto i=0; i<iterations; ++i)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (auto j=0; j<modules.size(); ++j)
+        {
+            auto bytes = std::as_bytes(std::span(encoded[j]));
+            decoded.resize(shaderfax::decodedSpirvSize(bytes));
+            if (!shaderfax::decodeSpirv(bytes,decoded) || decoded != modules[j])
+            {
+                std::cerr<< "Module "<<j<<" did not round trip\n";
+                return EXIT_FAILURE;
+            }
+        }
+        bestDecode = std::min<std::chrono::nanoseconds>(bestDecode,std::chrono::steady_clock::now() - start);
+    }
+
+    auto megabytesPerSecond = [&](std::chrono::nanoseconds elapsed){return rawSize / std::chrono::duration<double>(elapsed).count() / (1024*1024);};
+    std::cout<< modules.size()<<" modules, "<<rawSize<<" bytes raw, "<<encodedSize<<" bytes encoded, ratio "
+             <<(double)encodedSize/rawSize<<"\n"
+             <<"encode "<<megabytesPerSecond(bestEncode)<<" MB/s, decode "<<megabytesPerSecond(bestDecode)<<" MB/s\n";
+    return 0;
+}
+
+void loadModules(const std::filesystem::path& directory, std::vector<std::vector<uint32_t>>& modules)
+{
+    auto addFile = [&](const shaderfax::ShaderFileView& file)
+    {
+        for (auto i=0; i<file.stageCount(); ++i)
+        {
+            auto stage = file.stage(i);
+            std::vector<uint32_t> words(stage.wordCount());
+            if (stage.decode(words))
+            {
+                modules.push_back(std::move(words));
+            }
+        }
+    };
+    std::error_code error;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(directory,error))
+    {
+        if (entry.path().extension() == ".cshdr")
+        {
+            shaderfax::ShaderFile file;
+            if (file.open(entry.path()))
+            {
+                addFile(file);
+            }
+        }
+        else if (entry.path().extension() == ".shpak")
+        {
+            shaderfax::ShaderPack pack;
+            if (!pack.open(entry.path()))
+            {
+                continue;
+            }
+            for (auto i=0; i<pack.size(); ++i)
+            {
+                shaderfax::ShaderFileView file;
+                if (pack.file(i,file))
+                {
+                    addFile(file);
+                }
+            }
+        }
+    }
+}
+
+///Builds modules shaped like compiler output: a header, type declarations and function bodies of loads, arithmetic and
+///stores on recently defined ids
+void generateModules(size_t count, size_t instructions, std::vector<std::vector<uint32_t>>& modules)
+{
+    std::mt19937 random(1234);
+    for (auto i=0; i<count; ++i)
+    {
+        std::vector<uint32_t> words = {shaderfax::spirv::MAGIC,0x00010500,0x00280000,0,0};
+        uint32_t nextId = 1;
+        auto instruction = [&](uint32_t opcode, std::initializer_list<uint32_t> operands)
+        {
+            words.push_back((uint32_t)(operands.size() + 1) << 16 | opcode);
+            words.insert(words.end(),operands);
+        };
+        instruction(17,{1});
+        instruction(14,{0,1});
+        uint32_t floatType = nextId++;
+        instruction(22,{floatType,32});
+        uint32_t vectorType = nextId++;
+        instruction(23,{vectorType,floatType,4});
+        uint32_t pointerType = nextId++;
+        instruction(32,{pointerType,7,vectorType});
+        std::vector<uint32_t> variables;
+        for (auto j=0; j<8; ++j)
+        {
+            variables.push_back(nextId);
+            instruction(71,{nextId,30,(uint32_t)j});
+            instruction(59,{pointerType,nextId++,7});
+        }
+        instruction(248,{nextId++});
+        for (auto j=0; j<instructions; ++j)
+        {
+            auto recent = [&](){return nextId - 1 - (uint32_t)(random() % std::min<uint32_t>(nextId - 1,12));};
+            switch (random() % 4)
+            {
+                case 0:
+                    instruction(61,{vectorType,nextId++,variables[random() % variables.size()]});
+                    break;
+                case 1:
+                    instruction(62,{variables[random() % variables.size()],recent()});
+                    break;
+                default:
+                {
+                    auto a = recent();
+                    auto b = recent();
+                    instruction(129 + (uint32_t)(random() % 8),{vectorType,nextId++,a,b});
+                    break;
+                }
+            }
+        }
+        instruction(253,{});
+        words[3] = nextId;
+        modules.push_back(std::move(words));
+    }
+}
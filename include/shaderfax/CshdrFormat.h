@@ -0,0 +1,311 @@
+#ifndef SHADERFAX_CSHDRFORMAT_H
+#define SHADERFAX_CSHDRFORMAT_H
+#include <cstdint>
+#include <string_view>
+
+///Layout of version 2 .cshdr files. Every field is little endian and every record is naturally aligned, so a loader can map
+///the file and use the records and SPIR-V words in place.
+///
+///A file is a FileHeader, followed by sectionCount SectionHeaders, followed by the section contents. Sections hold arrays of
+///the records below and may appear in any order, loaders skip section types they don't know. Strings are interned into the
+///STRINGS section and referenced by StringRef, blobs are referenced by their index in the BLOBS section
+namespace shaderfax
+{
+  constexpr char CSHDR_V1_MAGIC[6] = {'c','s','h','d','r','\n'};
+  constexpr char CSHDR_V2_MAGIC[8] = {'c','s','h','d','r','2','\n','\0'};
+  constexpr uint32_t CSHDR_VERSION = 2;
+  ///Alignment of every blob payload, SPIR-V is an array of 32 bit words
+  constexpr uint32_t CSHDR_BLOB_ALIGNMENT = 4;
+  ///Alignment of every section
+  constexpr uint32_t CSHDR_SECTION_ALIGNMENT = 8;
+
+  enum SectionType : uint32_t
+  {
+    ///Array of StageRecord
+    SECTION_STAGES = 1,
+    ///Array of StringRef naming the parameters of every stage
+    SECTION_PARAMETERS = 2,
+    ///Array of DescriptorSetRecord
+    SECTION_DESCRIPTOR_SETS = 3,
+    ///Array of DescriptorRecord
+    SECTION_DESCRIPTORS = 4,
+    ///Array of BlobRecord
+    SECTION_BLOBS = 5,
+    ///NUL terminated strings, count is the size in bytes
+    SECTION_STRINGS = 6,
+    ///Array of uint64_t, a content hash of every blob's decoded code in BLOBS order. Equal ids mean equal code, in any
+    ///file of any build, so loaders can share shader modules between them
+    SECTION_BLOB_IDS = 7,
+    ///Array of VariantAxisRecord, the macros of the matrix the file was compiled from
+    SECTION_VARIANT_AXES = 8,
+    ///Array of StringRef, the values of every variant axis
+    SECTION_VARIANT_VALUES = 9,
+    ///Array of VariantRecord indexed by variant key, the count is a power of two
+    SECTION_VARIANTS = 10,
+    ///Array of TargetCodeRecord sorted by stage, the code of stages for targets besides SPIR-V
+    SECTION_TARGET_CODE = 11,
+    ///Array of StringRef in STAGES order, the name of every stage's entry point in its code. Files without the section
+    ///call every entry point main
+    SECTION_ENTRY_POINTS = 12,
+    ///Array of PushConstantRecord in STAGES order, the push constant block of every stage. Files without the section have
+    ///no push constants
+    SECTION_PUSH_CONSTANTS = 13,
+    ///Array of UniformBufferRecord, the member layout of uniform buffers holding the ordinary data of a descriptor set
+    SECTION_UNIFORM_BUFFERS = 14,
+    ///Array of UniformMemberRecord
+    SECTION_UNIFORM_MEMBERS = 15,
+    ///Array of DescriptorLayoutRecord in DESCRIPTOR_SETS order, the shared layout of every descriptor set
+    SECTION_DESCRIPTOR_LAYOUTS = 16,
+    ///Array of StringRef, the descriptors of files with FILE_FLAG_SHARED_LAYOUTS in place of DESCRIPTORS. The names of
+    ///every set are in the binding order of its layout
+    SECTION_DESCRIPTOR_NAMES = 17
+  };
+
+  enum FileFlags : uint32_t
+  {
+    ///BlobRecord offsets are relative to the start of the enclosing .shpak, set on files whose blobs a pack shares
+    FILE_FLAG_PACKED_BLOBS = 1,
+    ///Descriptors are only named, their binding, type and count are those of the set's layout in the build's layout table
+    FILE_FLAG_SHARED_LAYOUTS = 2
+  };
+
+  ///Targets code can be generated for besides SPIR-V, which every stage has
+  enum CodeTarget : uint32_t
+  {
+    ///GLSL source
+    CODE_TARGET_GLSL = 1,
+    ///HLSL source
+    CODE_TARGET_HLSL = 2,
+    ///C++ source of the entry point, for running shaders on the CPU
+    CODE_TARGET_CPP = 3
+  };
+
+  ///Bits of PushConstantRecord::stageFlags, equal to VkShaderStageFlagBits so they can be handed to Vulkan as they are
+  enum StageFlags : uint32_t
+  {
+    STAGE_VERTEX = 0x1,
+    STAGE_HULL = 0x2,
+    STAGE_DOMAIN = 0x4,
+    STAGE_GEOMETRY = 0x8,
+    STAGE_FRAGMENT = 0x10,
+    STAGE_COMPUTE = 0x20,
+    STAGE_TASK = 0x40,
+    STAGE_MESH = 0x80,
+    STAGE_RAY_GENERATION = 0x100,
+    STAGE_ANY_HIT = 0x200,
+    STAGE_CLOSEST_HIT = 0x400,
+    STAGE_MISS = 0x800,
+    STAGE_INTERSECTION = 0x1000,
+    STAGE_CALLABLE = 0x2000
+  };
+
+  ///Scalar type of a uniform member, vectors and matrices hold rows x columns of it
+  enum UniformType : uint32_t
+  {
+    ///Data without a single scalar type, like an array nested in an array of structs, copied as bytes
+    UNIFORM_TYPE_UNKNOWN = 0,
+    UNIFORM_TYPE_BOOL = 1,
+    UNIFORM_TYPE_INT8 = 2,
+    UNIFORM_TYPE_UINT8 = 3,
+    UNIFORM_TYPE_INT16 = 4,
+    UNIFORM_TYPE_UINT16 = 5,
+    UNIFORM_TYPE_INT32 = 6,
+    UNIFORM_TYPE_UINT32 = 7,
+    UNIFORM_TYPE_INT64 = 8,
+    UNIFORM_TYPE_UINT64 = 9,
+    UNIFORM_TYPE_FLOAT16 = 10,
+    UNIFORM_TYPE_FLOAT32 = 11,
+    UNIFORM_TYPE_FLOAT64 = 12
+  };
+
+  ///64 bit FNV-1a of a uniform member name, the nameHash of UniformMemberRecord. Loaders can hash the names they set at
+  ///compile time
+  constexpr uint64_t uniformNameHash(std::string_view name)
+  {
+    uint64_t hash = 14695981039346656037ULL;
+    for (char character: name)
+    {
+      hash ^= (uint8_t)character;
+      hash *= 1099511628211ULL;
+    }
+    return hash;
+  }
+
+  enum BlobEncoding : uint32_t
+  {
+    ///Raw SPIR-V words
+    BLOB_ENCODING_NONE = 0,
+    ///SPIR-V compressed with encodeSpirv from shaderfax/SpirvCodec.h
+    BLOB_ENCODING_SPIRV = 1
+  };
+
+  struct FileHeader
+  {
+    char magic[8];
+    uint32_t version;
+    ///Size of this header, lets later versions append fields
+    uint32_t headerSize;
+    uint64_t fileSize;
+    uint32_t sectionCount;
+    ///FileFlags
+    uint32_t flags;
+  };
+
+  struct SectionHeader
+  {
+    uint32_t type;
+    ///Number of records in the section
+    uint32_t count;
+    ///Offset from the start of the file
+    uint64_t offset;
+    ///Size in bytes
+    uint64_t size;
+  };
+
+  ///String in the STRINGS section, size excludes the terminating NUL
+  struct StringRef
+  {
+    uint32_t offset;
+    uint32_t size;
+  };
+
+  struct BlobRecord
+  {
+    ///Offset from the start of the file, a multiple of CSHDR_BLOB_ALIGNMENT
+    uint64_t offset;
+    uint32_t size;
+    uint32_t encoding;
+  };
+
+  struct StageRecord
+  {
+    StringRef stage;
+    ///Range in the PARAMETERS section
+    uint32_t firstParameter;
+    uint32_t parameterCount;
+    ///Index in the BLOBS section
+    uint32_t blob;
+    uint32_t reserved;
+  };
+
+  struct DescriptorSetRecord
+  {
+    ///Set number in the pipeline layout
+    uint32_t set;
+    ///Range in the DESCRIPTORS section, or DESCRIPTOR_NAMES for files sharing layouts
+    uint32_t firstDescriptor;
+    uint32_t descriptorCount;
+    uint32_t reserved;
+  };
+
+  struct DescriptorRecord
+  {
+    StringRef name;
+    uint32_t binding;
+    ///Value of DescriptorType
+    uint32_t type;
+    uint32_t count;
+    uint32_t reserved;
+  };
+
+  ///Macro of a variant matrix. A variant key holds the index of the axis value in bits [shift, shift + bits)
+  struct VariantAxisRecord
+  {
+    StringRef name;
+    uint32_t shift;
+    uint32_t bits;
+    ///Range in the VARIANT_VALUES section
+    uint32_t firstValue;
+    uint32_t valueCount;
+  };
+
+  ///Stages and descriptor sets compiled for one combination of macro values. Variants with identical output share ranges,
+  ///keys that name no combination have a stageCount of zero
+  struct VariantRecord
+  {
+    ///Range in the STAGES section
+    uint32_t firstStage;
+    uint32_t stageCount;
+    ///Range in the DESCRIPTOR_SETS section
+    uint32_t firstDescriptorSet;
+    uint32_t descriptorSetCount;
+  };
+
+  struct TargetCodeRecord
+  {
+    ///Index in the STAGES section
+    uint32_t stage;
+    ///Value of CodeTarget
+    uint32_t target;
+    ///Index in the BLOBS section
+    uint32_t blob;
+    uint32_t reserved;
+  };
+
+  ///Bytes [offset, offset + size) of the push constants, the layout of a VkPushConstantRange. A stage without push
+  ///constants has a size of zero
+  struct PushConstantRecord
+  {
+    ///StageFlags of the stages using the range
+    uint32_t stageFlags;
+    uint32_t offset;
+    uint32_t size;
+    uint32_t reserved;
+  };
+
+  ///Descriptor set layout in a layout table, see shaderfax/LayoutFormat.h
+  struct DescriptorLayoutRecord
+  {
+    uint64_t id;
+    ///StageFlags of the stages the set is bound for, part of the layout
+    uint32_t stageFlags;
+    uint32_t reserved;
+  };
+
+  struct UniformBufferRecord
+  {
+    ///Index in the DESCRIPTORS section of the uniform buffer, or DESCRIPTOR_NAMES for files sharing layouts
+    uint32_t descriptor;
+    ///Size of the buffer in bytes
+    uint32_t size;
+    ///Range in the UNIFORM_MEMBERS section
+    uint32_t firstMember;
+    uint32_t memberCount;
+  };
+
+  ///Field of a uniform buffer. Fields of nested structs are named by their path like "light.color", fields of an array of
+  ///structs are recorded once with the stride of the array
+  struct UniformMemberRecord
+  {
+    uint64_t nameHash;
+    StringRef name;
+    ///Offset of the first element from the start of the buffer
+    uint32_t offset;
+    ///Bytes of one element
+    uint32_t size;
+    ///Value of UniformType
+    uint32_t type;
+    uint16_t rows;
+    uint16_t columns;
+    ///Element i is at offset + i*arrayStride, a count of 1 for members that aren't arrays
+    uint32_t arrayCount;
+    uint32_t arrayStride;
+  };
+
+  static_assert(sizeof(FileHeader) == 32);
+  static_assert(sizeof(SectionHeader) == 24);
+  static_assert(sizeof(StringRef) == 8);
+  static_assert(sizeof(BlobRecord) == 16);
+  static_assert(sizeof(StageRecord) == 24);
+  static_assert(sizeof(DescriptorSetRecord) == 16);
+  static_assert(sizeof(DescriptorRecord) == 24);
+  static_assert(sizeof(VariantAxisRecord) == 24);
+  static_assert(sizeof(VariantRecord) == 16);
+  static_assert(sizeof(TargetCodeRecord) == 16);
+  static_assert(sizeof(PushConstantRecord) == 16);
+  static_assert(sizeof(DescriptorLayoutRecord) == 16);
+  static_assert(sizeof(UniformBufferRecord) == 16);
+  static_assert(sizeof(UniformMemberRecord) == 40);
+}
+
+#endif //SHADERFAX_CSHDRFORMAT_H
@@ -0,0 +1,51 @@
+#ifndef SHADERFAX_LAYOUTFORMAT_H
+#define SHADERFAX_LAYOUTFORMAT_H
+#include <cstdint>
+
+///Layout of descriptor layout tables (.sflt), which hold every distinct descriptor set layout of a build once. Every field
+///is little endian.
+///
+///A table is a LayoutTableHeader, the LayoutRecords sorted by id and then the bindings of every layout. v2 .cshdr files
+///name the layout of each of their descriptor sets by id in their DESCRIPTOR_LAYOUTS section. Ids are the XXH64 of a
+///layout's LayoutBindingRecords sorted by binding, so tables of sharded builds combine without renumbering. Files with
+///FILE_FLAG_SHARED_LAYOUTS only name their descriptors and take the rest from the table
+namespace shaderfax
+{
+  constexpr char LAYOUT_TABLE_MAGIC[8] = {'s','f','l','a','y','o','u','t'};
+  constexpr uint32_t LAYOUT_TABLE_VERSION = 1;
+
+  struct LayoutTableHeader
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t fileSize;
+    uint32_t layoutCount;
+    uint32_t bindingCount;
+  };
+
+  struct LayoutRecord
+  {
+    uint64_t id;
+    ///Range in the bindings following the layouts
+    uint32_t firstBinding;
+    uint32_t bindingCount;
+  };
+
+  ///The fields of a VkDescriptorSetLayoutBinding
+  struct LayoutBindingRecord
+  {
+    uint32_t binding;
+    ///Value of DescriptorType
+    uint32_t type;
+    uint32_t count;
+    ///StageFlags of the stages the set is bound for
+    uint32_t stageFlags;
+  };
+
+  static_assert(sizeof(LayoutTableHeader) == 32);
+  static_assert(sizeof(LayoutRecord) == 16);
+  static_assert(sizeof(LayoutBindingRecord) == 16);
+}
+
+#endif //SHADERFAX_LAYOUTFORMAT_H
@@ -0,0 +1,59 @@
+#ifndef SHADERFAX_PACKFORMAT_H
+#define SHADERFAX_PACKFORMAT_H
+#include <cstdint>
+#include <string_view>
+
+#include "CshdrFormat.h"
+
+///Layout of .shpak archives, which hold every .cshdr file of a build. Every field is little endian.
+///
+///A pack is a PackHeader, the bucket table, the entry table, the path strings and then the contents of every .cshdr file,
+///each starting on a PACK_FILE_ALIGNMENT boundary so v2 files can be used in place. Entries are sorted by bucket, which is
+///the low bits of the FNV-1a hash of their path, and bucket b owns entries [buckets[b], buckets[b+1])
+namespace shaderfax
+{
+  constexpr char PACK_MAGIC[8] = {'s','h','p','a','k','\n','\0','\0'};
+  constexpr uint32_t PACK_VERSION = 1;
+  constexpr uint32_t PACK_FILE_ALIGNMENT = 8;
+
+  struct PackHeader
+  {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t fileSize;
+    uint32_t entryCount;
+    ///Power of two, the bucket table holds bucketCount + 1 offsets
+    uint32_t bucketCount;
+    uint64_t bucketsOffset;
+    uint64_t entriesOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+  };
+
+  struct PackEntry
+  {
+    uint64_t hash;
+    ///Relative path of the .cshdr file with forward slashes
+    StringRef path;
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  static_assert(sizeof(PackHeader) == 64);
+  static_assert(sizeof(PackEntry) == 32);
+
+  ///64 bit FNV-1a, the hash of pack entry paths
+  constexpr uint64_t packHash(std::string_view path)
+  {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (char character: path)
+    {
+      hash ^= (uint8_t)character;
+      hash *= 0x100000001b3ull;
+    }
+    return hash;
+  }
+}
+
+#endif //SHADERFAX_PACKFORMAT_H
@@ -0,0 +1,1201 @@
+#ifndef SHADERFAX_READER_H
+#define SHADERFAX_READER_H
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "CshdrFormat.h"
+#include "LayoutFormat.h"
+#include "PackFormat.h"
+#include "SpirvCodec.h"
+
+///Header only reader for .cshdr files, .shpak archives and descriptor layout tables. Files are validated once when opened, after that every accessor returns views into
+///the file without allocating or copying. Indices passed to accessors have to be below the matching count, which debug builds
+///assert
+namespace shaderfax
+{
+  static_assert(std::endian::native == std::endian::little, "The reader uses file records in place and needs a little endian host");
+
+  ///Read only memory mapping of a whole file
+  class MappedFile
+  {
+  private:
+    const std::byte* _data = nullptr;
+    size_t _size = 0;
+#ifdef _WIN32
+    HANDLE _file = INVALID_HANDLE_VALUE;
+    HANDLE _mapping = nullptr;
+#endif
+  public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept
+    {
+      *this = std::move(other);
+    }
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+      if (this != &other)
+      {
+        close();
+        _data = std::exchange(other._data,nullptr);
+        _size = std::exchange(other._size,0);
+#ifdef _WIN32
+        _file = std::exchange(other._file,INVALID_HANDLE_VALUE);
+        _mapping = std::exchange(other._mapping,nullptr);
+#endif
+      }
+      return *this;
+    }
+    ~MappedFile()
+    {
+      close();
+    }
+
+    bool open(const std::filesystem::path& file)
+    {
+      close();
+#ifdef _WIN32
+      _file = CreateFileW(file.c_str(),GENERIC_READ,FILE_SHARE_READ,nullptr,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,nullptr);
+      LARGE_INTEGER size{};
+      if (_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(_file,&size) || size.QuadPart == 0)
+      {
+        close();
+        return false;
+      }
+      _mapping = CreateFileMappingW(_file,nullptr,PAGE_READONLY,0,0,nullptr);
+      _data = _mapping ? (const std::byte*)MapViewOfFile(_mapping,FILE_MAP_READ,0,0,0) : nullptr;
+      if (!_data)
+      {
+        close();
+        return false;
+      }
+      _size = size.QuadPart;
+#else
+      int descriptor = ::open(file.c_str(),O_RDONLY|O_CLOEXEC);
+      if (descriptor < 0)
+      {
+        return false;
+      }
+      struct stat status{};
+      if (fstat(descriptor,&status) != 0 || status.st_size == 0)
+      {
+        ::close(descriptor);
+        return false;
+      }
+      void* mapping = mmap(nullptr,status.st_size,PROT_READ,MAP_PRIVATE,descriptor,0);
+      ::close(descriptor);
+      if (mapping == MAP_FAILED)
+      {
+        return false;
+      }
+      _data = (const std::byte*)mapping;
+      _size = status.st_size;
+#endif
+      return true;
+    }
+
+    void close()
+    {
+#ifdef _WIN32
+      if (_data)
+      {
+        UnmapViewOfFile(_data);
+      }
+      if (_mapping)
+      {
+        CloseHandle(_mapping);
+      }
+      if (_file != INVALID_HANDLE_VALUE)
+      {
+        CloseHandle(_file);
+      }
+      _file = INVALID_HANDLE_VALUE;
+      _mapping = nullptr;
+#else
+      if (_data)
+      {
+        munmap((void*)_data,_size);
+      }
+#endif
+      _data = nullptr;
+      _size = 0;
+    }
+
+    std::span<const std::byte> data() const
+    {
+      return {_data,_size};
+    }
+  };
+
+  ///Names of a stage's parameters, either interned strings (v2) or a comma separated list (v1)
+  class StringList
+  {
+  private:
+    const StringRef* _references = nullptr;
+    const char* _strings = nullptr;
+    std::string_view _joined;
+    uint32_t _count = 0;
+  public:
+    StringList() = default;
+    StringList(const StringRef* references, uint32_t count, const char* strings) : _references(references), _strings(strings), _count(count) {}
+    StringList(std::string_view joined) : _joined(joined)
+    {
+      if (!joined.empty())
+      {
+        _count = 1;
+        for (char character: joined)
+        {
+          _count += character == ',';
+        }
+      }
+    }
+
+    size_t size() const
+    {
+      return _count;
+    }
+    bool empty() const
+    {
+      return _count == 0;
+    }
+    std::string_view operator[](size_t index) const
+    {
+      assert(index < _count);
+      if (_references)
+      {
+        return {_strings + _references[index].offset,_references[index].size};
+      }
+      auto remaining = _joined;
+      for (; index > 0; --index)
+      {
+        remaining.remove_prefix(remaining.find(',') + 1);
+      }
+      return remaining.substr(0,remaining.find(','));
+    }
+  };
+
+  ///Validated view over the bytes of a descriptor layout table, the bytes have to outlive it
+  class LayoutTableView
+  {
+  private:
+    uint32_t _layoutCount = 0;
+    const LayoutRecord* _layouts = nullptr;
+    const LayoutBindingRecord* _bindings = nullptr;
+  public:
+    bool parse(std::span<const std::byte> data)
+    {
+      *this = LayoutTableView();
+      if (data.size() < sizeof(LayoutTableHeader) || (uintptr_t)data.data() % alignof(uint64_t) != 0 || std::memcmp(data.data(),LAYOUT_TABLE_MAGIC,sizeof(LAYOUT_TABLE_MAGIC)) != 0)
+      {
+        return false;
+      }
+      auto header = (const LayoutTableHeader*)data.data();
+      uint64_t layoutsSize = (uint64_t)header->layoutCount*sizeof(LayoutRecord);
+      uint64_t bindingsSize = (uint64_t)header->bindingCount*sizeof(LayoutBindingRecord);
+      if (header->version != LAYOUT_TABLE_VERSION || header->headerSize < sizeof(LayoutTableHeader) || header->headerSize % alignof(LayoutRecord) != 0
+          || header->fileSize != data.size() || header->headerSize + layoutsSize + bindingsSize > data.size())
+      {
+        return false;
+      }
+      auto layouts = (const LayoutRecord*)(data.data() + header->headerSize);
+      for (uint32_t i=0; i<header->layoutCount; ++i)
+      {
+        auto& layout = layouts[i];
+        if ((i > 0 && layouts[i - 1].id >= layout.id) || layout.firstBinding > header->bindingCount || layout.bindingCount > header->bindingCount - layout.firstBinding)
+        {
+          return false;
+        }
+      }
+      _layoutCount = header->layoutCount;
+      _layouts = layouts;
+      _bindings = (const LayoutBindingRecord*)(data.data() + header->headerSize + layoutsSize);
+      return true;
+    }
+
+    size_t size() const
+    {
+      return _layoutCount;
+    }
+    uint64_t id(size_t index) const
+    {
+      assert(index < _layoutCount);
+      return _layouts[index].id;
+    }
+    std::span<const LayoutBindingRecord> bindings(size_t index) const
+    {
+      assert(index < _layoutCount);
+      return {_bindings + _layouts[index].firstBinding,_layouts[index].bindingCount};
+    }
+    ///Index of the layout with an id, found by binary search, or size() if there is none
+    size_t indexOf(uint64_t id) const
+    {
+      auto found = std::lower_bound(_layouts,_layouts + _layoutCount,id,[](const LayoutRecord& layout, uint64_t value){return layout.id < value;});
+      return found != _layouts + _layoutCount && found->id == id ? found - _layouts : _layoutCount;
+    }
+  };
+
+  struct DescriptorView
+  {
+    std::string_view name;
+    uint32_t binding = 0;
+    ///Value of DescriptorType
+    uint32_t type = 0;
+    uint32_t count = 0;
+  };
+
+  ///Member layout of a uniform buffer, enough to pack its data without reflecting the code
+  struct UniformBufferView
+  {
+    ///Bytes of the whole buffer
+    uint32_t size = 0;
+    std::span<const UniformMemberRecord> members;
+    const char* strings = nullptr;
+
+    std::string_view name(const UniformMemberRecord& member) const
+    {
+      return {strings + member.name.offset,member.name.size};
+    }
+    ///Member with a name hashed by uniformNameHash, null if the buffer has none
+    const UniformMemberRecord* find(uint64_t nameHash) const
+    {
+      for (auto& member: members)
+      {
+        if (member.nameHash == nameHash)
+        {
+          return &member;
+        }
+      }
+      return nullptr;
+    }
+    const UniformMemberRecord* find(std::string_view name) const
+    {
+      return find(uniformNameHash(name));
+    }
+  };
+
+  class DescriptorSetView
+  {
+  private:
+    uint32_t _set = 0;
+    uint32_t _count = 0;
+    const DescriptorRecord* _records = nullptr;
+    const char* _strings = nullptr;
+    const DescriptorLayoutRecord* _layout = nullptr;
+    ///Names and bindings of the layout of files sharing layouts, the bindings are null until a table resolved them
+    const StringRef* _names = nullptr;
+    const LayoutBindingRecord* _bindings = nullptr;
+    ///Start of the packed v1 descriptors when _records is null
+    const std::byte* _packed = nullptr;
+  public:
+    DescriptorSetView() = default;
+    DescriptorSetView(uint32_t set, const DescriptorRecord* records, uint32_t count, const char* strings, const DescriptorLayoutRecord* layout = nullptr)
+      : _set(set), _count(count), _records(records), _strings(strings), _layout(layout) {}
+    DescriptorSetView(uint32_t set, const StringRef* names, uint32_t count, const char* strings, const DescriptorLayoutRecord* layout, const LayoutBindingRecord* bindings)
+      : _set(set), _count(count), _strings(strings), _layout(layout), _names(names), _bindings(bindings) {}
+    DescriptorSetView(uint32_t set, const std::byte* packed, uint32_t count) : _set(set), _count(count), _packed(packed) {}
+
+    ///Set number in the pipeline layout
+    uint32_t set() const
+    {
+      return _set;
+    }
+    ///Id of the set's layout in the build's layout table, zero if the file doesn't record one
+    uint64_t layoutId() const
+    {
+      return _layout ? _layout->id : 0;
+    }
+    ///StageFlags of the stages the set is bound for, zero if the file doesn't record them
+    uint32_t stageFlags() const
+    {
+      return _layout ? _layout->stageFlags : 0;
+    }
+    size_t size() const
+    {
+      return _count;
+    }
+    DescriptorView operator[](size_t index) const
+    {
+      assert(index < _count);
+      if (_records)
+      {
+        auto& record = _records[index];
+        return {.name = {_strings + record.name.offset,record.name.size},.binding = record.binding,.type = record.type,.count = record.count};
+      }
+      if (_names)
+      {
+        DescriptorView view{.name = {_strings + _names[index].offset,_names[index].size}};
+        if (_bindings)
+        {
+          view.binding = _bindings[index].binding;
+          view.type = _bindings[index].type;
+          view.count = _bindings[index].count;
+        }
+        return view;
+      }
+      //v1 descriptors are a NUL terminated name, a 32 bit binding, an 8 bit type and a 32 bit count
+      auto position = (const char*)_packed;
+      for (;; --index)
+      {
+        std::string_view name(position);
+        position += name.size() + 1;
+        if (index == 0)
+        {
+          DescriptorView view{.name = name};
+          std::memcpy(&view.binding,position,sizeof(uint32_t));
+          view.type = (uint8_t)position[sizeof(uint32_t)];
+          std::memcpy(&view.count,position + sizeof(uint32_t) + 1,sizeof(uint32_t));
+          return view;
+        }
+        position += 2*sizeof(uint32_t) + 1;
+      }
+    }
+  };
+
+  struct StageView
+  {
+    std::string_view stage;
+    ///Name of the entry point in the code, several stages may share code with an entry point each
+    std::string_view entryPoint = "main";
+    StringList parameters;
+    std::span<const std::byte> code;
+    ///Value of BlobEncoding
+    uint32_t encoding = BLOB_ENCODING_NONE;
+    ///Content hash shared by every stage with the same code, zero if the file doesn't record one
+    uint64_t blobId = 0;
+    ///Push constant block of the stage, a size of zero if it has none or the file doesn't record them
+    PushConstantRecord pushConstants{};
+
+    ///SPIR-V words ready to hand to the driver, empty if the code is encoded or not 4 byte aligned (possible in v1 files)
+    std::span<const uint32_t> words() const
+    {
+      if (encoding != BLOB_ENCODING_NONE || code.size() % sizeof(uint32_t) != 0 || (uintptr_t)code.data() % alignof(uint32_t) != 0)
+      {
+        return {};
+      }
+      return {(const uint32_t*)code.data(),code.size()/sizeof(uint32_t)};
+    }
+    ///Number of SPIR-V words the code decodes to
+    size_t wordCount() const
+    {
+      return encoding == BLOB_ENCODING_SPIRV ? decodedSpirvSize(code) : code.size()/sizeof(uint32_t);
+    }
+    ///Decodes or copies the code into words, which must hold exactly wordCount() words
+    bool decode(std::span<uint32_t> words) const
+    {
+      switch (encoding)
+      {
+        case BLOB_ENCODING_NONE:
+          if (words.size()*sizeof(uint32_t) != code.size())
+          {
+            return false;
+          }
+          std::memcpy(words.data(),code.data(),code.size());
+          return true;
+        case BLOB_ENCODING_SPIRV:
+          return decodeSpirv(code,words);
+        default:
+          return false;
+      }
+    }
+  };
+
+  struct VariantAxisView
+  {
+    ///Macro name
+    std::string_view name;
+    StringList values;
+    uint32_t shift = 0;
+    uint32_t bits = 0;
+
+    ///Part of a variant key selecting the value at valueIndex, keys of whole variants are the bitwise or of one part per axis
+    uint32_t key(uint32_t valueIndex) const
+    {
+      return valueIndex << shift;
+    }
+  };
+
+  ///Ranges of the file's stages and descriptor sets making up one variant
+  struct VariantView
+  {
+    uint32_t firstStage = 0;
+    uint32_t stageCount = 0;
+    uint32_t firstDescriptorSet = 0;
+    uint32_t descriptorSetCount = 0;
+  };
+
+  ///Validated view over the bytes of a .cshdr file, the bytes have to outlive it
+  class ShaderFileView
+  {
+  private:
+    uint32_t _version = 0;
+    uint32_t _stageCount = 0;
+    uint32_t _descriptorSetCount = 0;
+    //v2
+    const std::byte* _data = nullptr;
+    const StageRecord* _stages = nullptr;
+    const StringRef* _parameters = nullptr;
+    const DescriptorSetRecord* _descriptorSets = nullptr;
+    const DescriptorRecord* _descriptors = nullptr;
+    const BlobRecord* _blobs = nullptr;
+    const uint64_t* _blobIds = nullptr;
+    uint32_t _blobCount = 0;
+    const VariantAxisRecord* _variantAxes = nullptr;
+    uint32_t _variantAxisCount = 0;
+    const StringRef* _variantValues = nullptr;
+    const VariantRecord* _variants = nullptr;
+    uint32_t _variantCount = 0;
+    const TargetCodeRecord* _targetCode = nullptr;
+    uint32_t _targetCodeCount = 0;
+    const StringRef* _entryPoints = nullptr;
+    const PushConstantRecord* _pushConstants = nullptr;
+    const DescriptorLayoutRecord* _descriptorLayouts = nullptr;
+    ///Descriptors of files sharing layouts, their bindings are in the table passed to resolveLayouts
+    const StringRef* _descriptorNames = nullptr;
+    bool _sharedLayouts = false;
+    const LayoutTableView* _layoutTable = nullptr;
+    const UniformBufferRecord* _uniformBuffers = nullptr;
+    uint32_t _uniformBufferCount = 0;
+    const UniformMemberRecord* _uniformMembers = nullptr;
+    ///What blob offsets are relative to, the file itself or the pack holding it
+    const std::byte* _blobBase = nullptr;
+    const char* _strings = nullptr;
+    size_t _metadataSize = 0;
+    //v1, start of the first descriptor set and the first stage
+    const std::byte* _firstSet = nullptr;
+    const std::byte* _firstStage = nullptr;
+    const std::byte* _end = nullptr;
+
+    template<typename T>
+    static bool sectionArray(std::span<const std::byte> data, const SectionHeader& section, const T*& records, uint32_t& count)
+    {
+      if (section.size != (uint64_t)section.count*sizeof(T) || section.offset % alignof(T) != 0)
+      {
+        return false;
+      }
+      records = (const T*)(data.data() + section.offset);
+      count = section.count;
+      return true;
+    }
+
+    bool validString(const StringRef& reference, uint32_t stringsSize) const
+    {
+      return (uint64_t)reference.offset + reference.size < stringsSize && _strings[reference.offset + reference.size] == '\0';
+    }
+
+    bool parseV2(std::span<const std::byte> data, std::span<const std::byte> container)
+    {
+      if (data.size() < sizeof(FileHeader) || (uintptr_t)data.data() % alignof(uint64_t) != 0)
+      {
+        return false;
+      }
+      auto header = (const FileHeader*)data.data();
+      if (header->version != CSHDR_VERSION || header->headerSize < sizeof(FileHeader) || header->headerSize > data.size() || header->fileSize != data.size()
+          || (data.size() - header->headerSize) / sizeof(SectionHeader) < header->sectionCount || header->headerSize % alignof(SectionHeader) != 0)
+      {
+        return false;
+      }
+      auto blobData = data;
+      if (header->flags & FILE_FLAG_PACKED_BLOBS)
+      {
+        if (container.empty())
+        {
+          return false;
+        }
+        blobData = container;
+      }
+      auto sections = (const SectionHeader*)(data.data() + header->headerSize);
+      _metadataSize = header->headerSize + header->sectionCount*sizeof(SectionHeader);
+      uint32_t parameterCount = 0;
+      uint32_t descriptorCount = 0;
+      uint32_t blobCount = 0;
+      uint32_t blobIdCount = 0;
+      uint32_t variantValueCount = 0;
+      uint32_t entryPointCount = 0;
+      uint32_t pushConstantCount = 0;
+      uint32_t uniformMemberCount = 0;
+      uint32_t descriptorLayoutCount = 0;
+      uint32_t stringsSize = 0;
+      for (uint32_t i=0; i<header->sectionCount; ++i)
+      {
+        auto& section = sections[i];
+        if (section.offset > data.size() || section.size > data.size() - section.offset)
+        {
+          return false;
+        }
+        _metadataSize = std::max<size_t>(_metadataSize,section.offset + section.size);
+        bool valid = true;
+        switch (section.type)
+        {
+          case SECTION_STAGES:
+            valid = sectionArray(data,section,_stages,_stageCount);
+            break;
+          case SECTION_PARAMETERS:
+            valid = sectionArray(data,section,_parameters,parameterCount);
+            break;
+          case SECTION_DESCRIPTOR_SETS:
+            valid = sectionArray(data,section,_descriptorSets,_descriptorSetCount);
+            break;
+          case SECTION_DESCRIPTORS:
+            valid = sectionArray(data,section,_descriptors,descriptorCount);
+            break;
+          case SECTION_BLOBS:
+            valid = sectionArray(data,section,_blobs,blobCount);
+            break;
+          case SECTION_BLOB_IDS:
+            valid = sectionArray(data,section,_blobIds,blobIdCount);
+            break;
+          case SECTION_VARIANT_AXES:
+            valid = sectionArray(data,section,_variantAxes,_variantAxisCount);
+            break;
+          case SECTION_VARIANT_VALUES:
+            valid = sectionArray(data,section,_variantValues,variantValueCount);
+            break;
+          case SECTION_VARIANTS:
+            valid = sectionArray(data,section,_variants,_variantCount) && (_variantCount == 0 || std::has_single_bit(_variantCount));
+            break;
+          case SECTION_ENTRY_POINTS:
+            valid = sectionArray(data,section,_entryPoints,entryPointCount);
+            break;
+          case SECTION_TARGET_CODE:
+            valid = sectionArray(data,section,_targetCode,_targetCodeCount);
+            break;
+          case SECTION_PUSH_CONSTANTS:
+            valid = sectionArray(data,section,_pushConstants,pushConstantCount);
+            break;
+          case SECTION_DESCRIPTOR_LAYOUTS:
+            valid = sectionArray(data,section,_descriptorLayouts,descriptorLayoutCount);
+            break;
+          case SECTION_DESCRIPTOR_NAMES:
+            valid = sectionArray(data,section,_descriptorNames,descriptorCount);
+            break;
+          case SECTION_UNIFORM_BUFFERS:
+            valid = sectionArray(data,section,_uniformBuffers,_uniformBufferCount);
+            break;
+          case SECTION_UNIFORM_MEMBERS:
+            valid = sectionArray(data,section,_uniformMembers,uniformMemberCount);
+            break;
+          case SECTION_STRINGS:
+            valid = section.size == section.count && (section.size == 0 || (char)data[section.offset + section.size - 1] == '\0');
+            _strings = (const char*)(data.data() + section.offset);
+            stringsSize = section.count;
+            break;
+          default:
+            //sections added by later writers
+            break;
+        }
+        if (!valid)
+        {
+          return false;
+        }
+      }
+
+      if (_blobIds && blobIdCount != blobCount)
+      {
+        return false;
+      }
+      //files sharing layouts only name their descriptors and find the rest through the layout of every set
+      _sharedLayouts = header->flags & FILE_FLAG_SHARED_LAYOUTS;
+      if (_sharedLayouts ? _descriptors || (_descriptorSetCount > 0 && (!_descriptorNames || !_descriptorLayouts)) : _descriptorNames != nullptr)
+      {
+        return false;
+      }
+      for (uint32_t i=0; i<blobCount; ++i)
+      {
+        auto& blob = _blobs[i];
+        if (blob.offset > blobData.size() || blob.size > blobData.size() - blob.offset || blob.offset % CSHDR_BLOB_ALIGNMENT != 0)
+        {
+          return false;
+        }
+      }
+      for (uint32_t i=0; i<parameterCount; ++i)
+      {
+        if (!validString(_parameters[i],stringsSize))
+        {
+          return false;
+        }
+      }
+      for (uint32_t i=0; i<_stageCount; ++i)
+      {
+        auto& stage = _stages[i];
+        if (!validString(stage.stage,stringsSize) || stage.blob >= blobCount || stage.firstParameter > parameterCount || stage.parameterCount > parameterCount - stage.firstParameter)
+        {
+          return false;
+        }
+      }
+      for (uint32_t i=0; i<descriptorCount; ++i)
+      {
+        if (!validString(_descriptors ? _descriptors[i].name : _descriptorNames[i],stringsSize))
+        {
+          return false;
+        }
+      }
+      for (uint32_t i=0; i<_descriptorSetCount; ++i)
+      {
+        auto& descriptorSet = _descriptorSets[i];
+        if (descriptorSet.firstDescriptor > descriptorCount || descriptorSet.descriptorCount > descriptorCount - descriptorSet.firstDescriptor)
+        {
+          return false;
+        }
+      }
+      for (uint32_t i=0; i<_uniformBufferCount; ++i)
+      {
+        auto& buffer = _uniformBuffers[i];
+        if (buffer.descriptor >= descriptorCount || buffer.firstMember > uniformMemberCount || buffer.memberCount > uniformMemberCount - buffer.firstMember)
+        {
+          return false;
+        }
+      }
+      for (uint32_t i=0; i<uniformMemberCount; ++i)
+      {
+        if (!validString(_uniformMembers[i].name,stringsSize))
+        {
+          return false;
+        }
+      }
+      if ((_entryPoints && entryPointCount != _stageCount) || (_pushConstants && pushConstantCount != _stageCount)
+          || (_descriptorLayouts && descriptorLayoutCount != _descriptorSetCount))
+      {
+        return false;
+      }
+      for (uint32_t i=0; i<entryPointCount; ++i)
+      {
+        if (!validString(_entryPoints[i],stringsSize))
+        {
+          return false;
+        }
+      }
+      for (uint32_t i=0; i<_targetCodeCount; ++i)
+      {
+        if (_targetCode[i].stage >= _stageCount || _targetCode[i].blob >= blobCount)
+        {
+          return false;
+        }
+      }
+      for (uint32_t i=0; i<variantValueCount; ++i)
+      {
+        if (!validString(_variantValues[i],stringsSize))
+        {
+          return false;
+        }
+      }
+      for (uint32_t i=0; i<_variantAxisCount; ++i)
+      {
+        auto& axis = _variantAxes[i];
+        if (!validString(axis.name,stringsSize) || axis.firstValue > variantValueCount || axis.valueCount > variantValueCount - axis.firstValue
+            || axis.bits >= 32 || axis.shift >= 32 || (axis.valueCount > 1 && ((axis.valueCount - 1) >> axis.bits) != 0))
+        {
+          return false;
+        }
+      }
+      for (uint32_t i=0; i<_variantCount; ++i)
+      {
+        auto& variant = _variants[i];
+        if (variant.firstStage > _stageCount || variant.stageCount > _stageCount - variant.firstStage
+            || variant.firstDescriptorSet > _descriptorSetCount || variant.descriptorSetCount > _descriptorSetCount - variant.firstDescriptorSet)
+        {
+          return false;
+        }
+      }
+      _data = data.data();
+      _blobBase = blobData.data();
+      _blobCount = blobCount;
+      _version = 2;
+      return true;
+    }
+
+    bool parseV1(std::span<const std::byte> data)
+    {
+      auto position = (const char*)data.data() + sizeof(CSHDR_V1_MAGIC);
+      auto end = (const char*)data.data() + data.size();
+      if (position >= end)
+      {
+        return false;
+      }
+      _descriptorSetCount = (uint8_t)*position++;
+      _firstSet = (const std::byte*)position;
+      for (uint32_t i=0; i<_descriptorSetCount; ++i)
+      {
+        if (position >= end)
+        {
+          return false;
+        }
+        uint8_t descriptorCount = *position++;
+        for (uint32_t j=0; j<descriptorCount; ++j)
+        {
+          auto terminator = (const char*)std::memchr(position,'\0',end - position);
+          if (!terminator || end - terminator - 1 < 2*(ptrdiff_t)sizeof(uint32_t) + 1)
+          {
+            return false;
+          }
+          position = terminator + 1 + 2*sizeof(uint32_t) + 1;
+        }
+      }
+      _firstStage = (const std::byte*)position;
+      while (position < end)
+      {
+        std::string_view remaining(position,end - position);
+        auto open = remaining.find(":<");
+        auto close = remaining.find('>');
+        if (open == std::string_view::npos || close == std::string_view::npos || close < open || end - position - close - 1 < (ptrdiff_t)sizeof(uint32_t))
+        {
+          return false;
+        }
+        position += close + 1;
+        uint32_t size = 0;
+        std::memcpy(&size,position,sizeof(uint32_t));
+        position += sizeof(uint32_t);
+        if (end - position < size)
+        {
+          return false;
+        }
+        position += size;
+        ++_stageCount;
+      }
+      _end = (const std::byte*)end;
+      _version = 1;
+      return true;
+    }
+
+    StageView stageView(size_t index, uint32_t blobIndex) const
+    {
+      auto& record = _stages[index];
+      auto& blob = _blobs[blobIndex];
+      return {
+        .stage = {_strings + record.stage.offset,record.stage.size},
+        .entryPoint = _entryPoints ? std::string_view(_strings + _entryPoints[index].offset,_entryPoints[index].size) : "main",
+        .parameters = StringList(_parameters + record.firstParameter,record.parameterCount,_strings),
+        .code = {_blobBase + blob.offset,blob.size},
+        .encoding = blob.encoding,
+        .blobId = _blobIds ? _blobIds[blobIndex] : 0,
+        .pushConstants = _pushConstants ? _pushConstants[index] : PushConstantRecord{}
+      };
+    }
+
+  public:
+    ///Validates the file, returns false for unknown versions and anything truncated or out of bounds. Files stored in a
+    ///pack may keep their code in the pack, which then has to be passed as the container
+    bool parse(std::span<const std::byte> data, std::span<const std::byte> container = {})
+    {
+      *this = ShaderFileView();
+      bool valid = false;
+      if (data.size() >= sizeof(CSHDR_V2_MAGIC) && std::memcmp(data.data(),CSHDR_V2_MAGIC,sizeof(CSHDR_V2_MAGIC)) == 0)
+      {
+        valid = parseV2(data,container);
+      }
+      else if (data.size() >= sizeof(CSHDR_V1_MAGIC) && std::memcmp(data.data(),CSHDR_V1_MAGIC,sizeof(CSHDR_V1_MAGIC)) == 0)
+      {
+        valid = parseV1(data);
+      }
+      if (!valid)
+      {
+        *this = ShaderFileView();
+      }
+      return valid;
+    }
+
+    uint32_t version() const
+    {
+      return _version;
+    }
+
+    size_t stageCount() const
+    {
+      return _stageCount;
+    }
+    StageView stage(size_t index) const
+    {
+      assert(index < _stageCount);
+      if (_version == 2)
+      {
+        return stageView(index,_stages[index].blob);
+      }
+      auto position = (const char*)_firstStage;
+      for (;; --index)
+      {
+        std::string_view header(position,(const char*)_end - position);
+        auto open = header.find(":<");
+        auto close = header.find('>');
+        uint32_t size = 0;
+        std::memcpy(&size,position + close + 1,sizeof(uint32_t));
+        auto code = (const std::byte*)position + close + 1 + sizeof(uint32_t);
+        if (index == 0)
+        {
+          return {.stage = header.substr(0,open),.parameters = StringList(header.substr(open + 2,close - open - 2)),.code = {code,size}};
+        }
+        position = (const char*)code + size;
+      }
+    }
+    ///First stage with the given name
+    std::optional<StageView> findStage(std::string_view name) const
+    {
+      for (size_t i=0; i<_stageCount; ++i)
+      {
+        auto view = stage(i);
+        if (view.stage == name)
+        {
+          return view;
+        }
+      }
+      return std::nullopt;
+    }
+
+    ///A stage compiled for a target besides SPIR-V, if the file has code for it
+    std::optional<StageView> targetCode(size_t stage, CodeTarget target) const
+    {
+      for (uint32_t i=0; i<_targetCodeCount; ++i)
+      {
+        auto& record = _targetCode[i];
+        if (record.stage == stage && record.target == target)
+        {
+          return stageView(stage,record.blob);
+        }
+      }
+      return std::nullopt;
+    }
+
+    size_t descriptorSetCount() const
+    {
+      return _descriptorSetCount;
+    }
+
+    ///Whether the file was compiled from a variant matrix
+    bool hasVariants() const
+    {
+      return _variantCount != 0;
+    }
+    size_t variantAxisCount() const
+    {
+      return _variantAxisCount;
+    }
+    VariantAxisView variantAxis(size_t index) const
+    {
+      assert(index < _variantAxisCount);
+      auto& axis = _variantAxes[index];
+      return {.name = {_strings + axis.name.offset,axis.name.size},.values = StringList(_variantValues + axis.firstValue,axis.valueCount,_strings),.shift = axis.shift,.bits = axis.bits};
+    }
+    ///Variant axis for a macro
+    std::optional<VariantAxisView> findVariantAxis(std::string_view name) const
+    {
+      for (size_t i=0; i<_variantAxisCount; ++i)
+      {
+        auto view = variantAxis(i);
+        if (view.name == name)
+        {
+          return view;
+        }
+      }
+      return std::nullopt;
+    }
+    ///Stages and descriptor sets of the variant with the given key, a single table lookup. Files without variants have one
+    ///variant with key zero spanning everything
+    std::optional<VariantView> variant(uint32_t key) const
+    {
+      if (_variantCount == 0)
+      {
+        if (key != 0 || _version == 0)
+        {
+          return std::nullopt;
+        }
+        return VariantView{.firstStage = 0,.stageCount = _stageCount,.firstDescriptorSet = 0,.descriptorSetCount = _descriptorSetCount};
+      }
+      if (key >= _variantCount || _variants[key].stageCount == 0)
+      {
+        return std::nullopt;
+      }
+      auto& record = _variants[key];
+      return VariantView{.firstStage = record.firstStage,.stageCount = record.stageCount,.firstDescriptorSet = record.firstDescriptorSet,.descriptorSetCount = record.descriptorSetCount};
+    }
+
+    ///Push constant ranges of a variant's stages ready for a VkPipelineLayoutCreateInfo, stages with the same range share
+    ///one with their flags combined. Writes at most ranges.size() of them and returns how many there are
+    size_t pushConstantRanges(const VariantView& variant, std::span<PushConstantRecord> ranges) const
+    {
+      size_t count = 0;
+      for (uint32_t i=0; _pushConstants && i<variant.stageCount; ++i)
+      {
+        auto& stage = _pushConstants[variant.firstStage + i];
+        if (stage.size == 0)
+        {
+          continue;
+        }
+        auto written = std::min(count,ranges.size());
+        auto same = std::find_if(ranges.begin(),ranges.begin() + written,[&](const PushConstantRecord& range){return range.offset == stage.offset && range.size == stage.size;});
+        if (same != ranges.begin() + written)
+        {
+          same->stageFlags |= stage.stageFlags;
+          continue;
+        }
+        if (count < ranges.size())
+        {
+          ranges[count] = {.stageFlags = stage.stageFlags,.offset = stage.offset,.size = stage.size,.reserved = 0};
+        }
+        ++count;
+      }
+      return count;
+    }
+
+    ///Member layout of a uniform buffer descriptor of a set, recorded for the buffer holding the set's ordinary data. v1
+    ///files don't record layouts
+    std::optional<UniformBufferView> uniformBuffer(size_t descriptorSet, size_t descriptor) const
+    {
+      assert(descriptorSet < _descriptorSetCount);
+      if (_version != 2)
+      {
+        return std::nullopt;
+      }
+      assert(descriptor < _descriptorSets[descriptorSet].descriptorCount);
+      auto index = _descriptorSets[descriptorSet].firstDescriptor + descriptor;
+      for (uint32_t i=0; i<_uniformBufferCount; ++i)
+      {
+        auto& buffer = _uniformBuffers[i];
+        if (buffer.descriptor == index)
+        {
+          return UniformBufferView{.size = buffer.size,.members = {_uniformMembers + buffer.firstMember,buffer.memberCount},.strings = _strings};
+        }
+      }
+      return std::nullopt;
+    }
+
+    ///Blob table of a v2 file, empty for v1
+    std::span<const BlobRecord> blobs() const
+    {
+      return {_blobs,_blobCount};
+    }
+    ///Bytes of a blob as they are stored, which for packed files is in the container
+    std::span<const std::byte> blobData(size_t index) const
+    {
+      assert(index < _blobCount);
+      return {_blobBase + _blobs[index].offset,_blobs[index].size};
+    }
+    ///Blob ids of a v2 file, empty if it has none
+    std::span<const uint64_t> blobIds() const
+    {
+      return {_blobIds,_blobIds ? _blobCount : 0};
+    }
+    ///Bytes of a v2 file taken up by its header and sections, everything else is code
+    size_t metadataSize() const
+    {
+      return _metadataSize;
+    }
+    ///Whether the file only names its descriptors, their binding, type and count are zero until resolveLayouts bound the
+    ///build's layout table
+    bool sharesLayouts() const
+    {
+      return _sharedLayouts;
+    }
+    ///Binds the descriptors of a file sharing layouts to the build's layout table, which has to outlive the view. Fails if
+    ///the table lacks a layout of the file, files that record their descriptors need no table
+    bool resolveLayouts(const LayoutTableView& table)
+    {
+      if (!_sharedLayouts)
+      {
+        return true;
+      }
+      for (uint32_t i=0; i<_descriptorSetCount; ++i)
+      {
+        auto layout = table.indexOf(_descriptorLayouts[i].id);
+        if (layout == table.size() || table.bindings(layout).size() != _descriptorSets[i].descriptorCount)
+        {
+          return false;
+        }
+      }
+      _layoutTable = &table;
+      return true;
+    }
+    DescriptorSetView descriptorSet(size_t index) const
+    {
+      assert(index < _descriptorSetCount);
+      if (_version == 2)
+      {
+        auto& record = _descriptorSets[index];
+        if (_sharedLayouts)
+        {
+          auto bindings = _layoutTable ? _layoutTable->bindings(_layoutTable->indexOf(_descriptorLayouts[index].id)).data() : nullptr;
+          return DescriptorSetView(record.set,_descriptorNames + record.firstDescriptor,record.descriptorCount,_strings,_descriptorLayouts + index,bindings);
+        }
+        return DescriptorSetView(record.set,_descriptors + record.firstDescriptor,record.descriptorCount,_strings,_descriptorLayouts ? _descriptorLayouts + index : nullptr);
+      }
+      //v1 files store sets in order without their number
+      auto position = (const char*)_firstSet;
+      for (size_t set = 0;; ++set)
+      {
+        uint8_t descriptorCount = *position++;
+        if (set == index)
+        {
+          return DescriptorSetView(set,(const std::byte*)position,descriptorCount);
+        }
+        for (uint32_t j=0; j<descriptorCount; ++j)
+        {
+          position += std::strlen(position) + 1 + 2*sizeof(uint32_t) + 1;
+        }
+      }
+    }
+  };
+
+  ///Validated view over the bytes of a .shpak archive, the bytes have to outlive it
+  class ShaderPackView
+  {
+  private:
+    const std::byte* _data = nullptr;
+    size_t _size = 0;
+    uint32_t _entryCount = 0;
+    uint32_t _bucketCount = 0;
+    const uint32_t* _buckets = nullptr;
+    const PackEntry* _entries = nullptr;
+    const char* _strings = nullptr;
+  public:
+    ///Validates the index, the files themselves are validated when they are looked up
+    bool parse(std::span<const std::byte> data)
+    {
+      *this = ShaderPackView();
+      if (data.size() < sizeof(PackHeader) || (uintptr_t)data.data() % alignof(uint64_t) != 0 || std::memcmp(data.data(),PACK_MAGIC,sizeof(PACK_MAGIC)) != 0)
+      {
+        return false;
+      }
+      auto header = (const PackHeader*)data.data();
+      auto inBounds = [&](uint64_t offset, uint64_t size){return offset <= data.size() && size <= data.size() - offset;};
+      if (header->version != PACK_VERSION || header->headerSize < sizeof(PackHeader) || header->fileSize != data.size()
+          || header->bucketCount == 0 || !std::has_single_bit(header->bucketCount)
+          || !inBounds(header->bucketsOffset,((uint64_t)header->bucketCount + 1)*sizeof(uint32_t)) || header->bucketsOffset % alignof(uint32_t) != 0
+          || !inBounds(header->entriesOffset,(uint64_t)header->entryCount*sizeof(PackEntry)) || header->entriesOffset % alignof(PackEntry) != 0
+          || !inBounds(header->stringsOffset,header->stringsSize))
+      {
+        return false;
+      }
+      auto buckets = (const uint32_t*)(data.data() + header->bucketsOffset);
+      auto entries = (const PackEntry*)(data.data() + header->entriesOffset);
+      auto strings = (const char*)(data.data() + header->stringsOffset);
+      if (buckets[0] != 0 || buckets[header->bucketCount] != header->entryCount)
+      {
+        return false;
+      }
+      for (uint32_t i=0; i<header->bucketCount; ++i)
+      {
+        if (buckets[i] > buckets[i + 1])
+        {
+          return false;
+        }
+      }
+      for (uint32_t i=0; i<header->entryCount; ++i)
+      {
+        auto& entry = entries[i];
+        if ((uint64_t)entry.path.offset + entry.path.size >= header->stringsSize || strings[entry.path.offset + entry.path.size] != '\0'
+            || !inBounds(entry.offset,entry.size) || entry.offset % PACK_FILE_ALIGNMENT != 0)
+        {
+          return false;
+        }
+      }
+      _data = data.data();
+      _size = data.size();
+      _entryCount = header->entryCount;
+      _bucketCount = header->bucketCount;
+      _buckets = buckets;
+      _entries = entries;
+      _strings = strings;
+      return true;
+    }
+
+    size_t size() const
+    {
+      return _entryCount;
+    }
+    std::string_view path(size_t index) const
+    {
+      assert(index < _entryCount);
+      return {_strings + _entries[index].path.offset,_entries[index].path.size};
+    }
+    std::span<const std::byte> data(size_t index) const
+    {
+      assert(index < _entryCount);
+      return {_data + _entries[index].offset,_entries[index].size};
+    }
+    ///Index of the file with the given relative path, or size() if there is none
+    size_t indexOf(std::string_view path) const
+    {
+      if (_entryCount == 0)
+      {
+        return _entryCount;
+      }
+      auto hash = packHash(path);
+      auto bucket = hash & (_bucketCount - 1);
+      for (auto i = _buckets[bucket]; i < _buckets[bucket + 1]; ++i)
+      {
+        if (_entries[i].hash == hash && this->path(i) == path)
+        {
+          return i;
+        }
+      }
+      return _entryCount;
+    }
+    ///Validates the file at an index
+    bool file(size_t index, ShaderFileView& file) const
+    {
+      return index < _entryCount && file.parse(data(index),{_data,_size});
+    }
+    ///Looks up and validates a file by its relative path
+    bool find(std::string_view path, ShaderFileView& file) const
+    {
+      return this->file(indexOf(path),file);
+    }
+  };
+
+  ///A mapped and validated .cshdr file
+  class ShaderFile : public ShaderFileView
+  {
+  private:
+    MappedFile _file;
+  public:
+    bool open(const std::filesystem::path& file)
+    {
+      return _file.open(file) && parse(_file.data());
+    }
+  };
+
+  ///A mapped and validated descriptor layout table
+  class LayoutTable : public LayoutTableView
+  {
+  private:
+    MappedFile _file;
+  public:
+    bool open(const std::filesystem::path& file)
+    {
+      return _file.open(file) && parse(_file.data());
+    }
+  };
+
+  ///A mapped .shpak archive with a validated index
+  class ShaderPack : public ShaderPackView
+  {
+  private:
+    MappedFile _file;
+  public:
+    bool open(const std::filesystem::path& file)
+    {
+      return _file.open(file) && parse(_file.data());
+    }
+  };
+}
+
+#endif //SHADERFAX_READER_H
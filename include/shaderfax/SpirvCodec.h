@@ -0,0 +1,299 @@
+#ifndef SHADERFAX_SPIRVCODEC_H
+#define SHADERFAX_SPIRVCODEC_H
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+///Lossless compression of SPIR-V word streams in the spirit of SMOL-V. Every word becomes a LEB128 varint, instruction
+///headers pack the opcode and a short word count together, result ids are stored as the difference to the previous result
+///and id operands as the difference to the current result, which turns most ids into one byte.
+///
+///An encoded blob is the varint word count of the module, the five header words and then the instructions. The operand
+///table below only decides which words are treated as ids, any module round trips exactly whatever the table says
+namespace shaderfax
+{
+  namespace spirv
+  {
+    constexpr uint32_t MAGIC = 0x07230203;
+    constexpr uint32_t HEADER_WORDS = 5;
+    ///Word counts up to this are stored in the instruction header
+    constexpr uint32_t INLINE_WORD_COUNT = 15;
+
+    enum OperandFlags : uint8_t
+    {
+      HAS_TYPE = 1,
+      HAS_RESULT = 2,
+      ///Every operand after the result is an id
+      ID_OPERANDS = 4,
+      ///Only the first operand after the result is an id
+      FIRST_ID_OPERAND = 8
+    };
+
+    constexpr uint8_t operandFlags(uint32_t opcode)
+    {
+      constexpr uint8_t VALUE = HAS_TYPE|HAS_RESULT|ID_OPERANDS;
+      switch (opcode)
+      {
+        case 1: //OpUndef
+        case 41: //OpConstantTrue
+        case 42: //OpConstantFalse
+        case 43: //OpConstant
+        case 54: //OpFunction
+        case 55: //OpFunctionParameter
+        case 59: //OpVariable
+          return HAS_TYPE|HAS_RESULT;
+        case 5: //OpName
+        case 6: //OpMemberName
+        case 8: //OpLine
+        case 16: //OpExecutionMode
+        case 71: //OpDecorate
+        case 72: //OpMemberDecorate
+        case 247: //OpSelectionMerge
+        case 251: //OpSwitch
+          return FIRST_ID_OPERAND;
+        case 7: //OpString
+        case 11: //OpExtInstImport
+        case 19: //OpTypeVoid
+        case 20: //OpTypeBool
+        case 21: //OpTypeInt
+        case 22: //OpTypeFloat
+        case 26: //OpTypeSampler
+        case 32: //OpTypePointer
+        case 248: //OpLabel
+          return HAS_RESULT;
+        case 23: //OpTypeVector
+        case 24: //OpTypeMatrix
+        case 25: //OpTypeImage
+          return HAS_RESULT|FIRST_ID_OPERAND;
+        case 27: //OpTypeSampledImage
+        case 28: //OpTypeArray
+        case 29: //OpTypeRuntimeArray
+        case 30: //OpTypeStruct
+        case 33: //OpTypeFunction
+          return HAS_RESULT|ID_OPERANDS;
+        case 61: //OpLoad
+        case 79: //OpVectorShuffle
+        case 81: //OpCompositeExtract
+        case 82: //OpCompositeInsert
+          return HAS_TYPE|HAS_RESULT|FIRST_ID_OPERAND;
+        case 62: //OpStore
+        case 99: //OpImageWrite
+        case 246: //OpLoopMerge
+        case 249: //OpBranch
+        case 250: //OpBranchConditional
+        case 254: //OpReturnValue
+          return ID_OPERANDS;
+        case 12: //OpExtInst
+        case 44: //OpConstantComposite
+        case 57: //OpFunctionCall
+        case 60: //OpImageTexelPointer
+        case 65: //OpAccessChain
+        case 66: //OpInBoundsAccessChain
+        case 80: //OpCompositeConstruct
+        case 83: //OpCopyObject
+        case 84: //OpTranspose
+        case 86: //OpSampledImage
+        case 87: //OpImageSampleImplicitLod
+        case 88: //OpImageSampleExplicitLod
+        case 95: //OpImageFetch
+        case 98: //OpImageRead
+        case 100: //OpImage
+        case 245: //OpPhi
+          return VALUE;
+        default:
+          //conversions, arithmetic, relational, logical, bitwise and derivative instructions
+          if ((opcode >= 109 && opcode <= 124) || (opcode >= 126 && opcode <= 152) || (opcode >= 154 && opcode <= 205) || (opcode >= 207 && opcode <= 215))
+          {
+            return VALUE;
+          }
+          return 0;
+      }
+    }
+
+    inline void appendVarint(std::vector<char>& encoded, uint32_t value)
+    {
+      while (value >= 0x80)
+      {
+        encoded.push_back((char)(value | 0x80));
+        value >>= 7;
+      }
+      encoded.push_back((char)value);
+    }
+
+    constexpr uint32_t zigzag(uint32_t value)
+    {
+      return (value << 1) ^ (uint32_t)((int32_t)value >> 31);
+    }
+
+    constexpr uint32_t unzigzag(uint32_t value)
+    {
+      return (value >> 1) ^ (0u - (value & 1));
+    }
+
+    ///Bounds checked varint reader
+    struct VarintReader
+    {
+      const std::byte* position;
+      const std::byte* end;
+      bool read(uint32_t& value)
+      {
+        value = 0;
+        for (uint32_t shift = 0; shift < 35; shift += 7)
+        {
+          if (position == end)
+          {
+            return false;
+          }
+          auto byte = (uint8_t)*position++;
+          value |= (uint32_t)(byte & 0x7f) << shift;
+          if (!(byte & 0x80))
+          {
+            return true;
+          }
+        }
+        return false;
+      }
+    };
+  }
+
+  ///Compresses a SPIR-V module, returns false if the words aren't a well formed module
+  inline bool encodeSpirv(std::span<const uint32_t> words, std::vector<char>& encoded)
+  {
+    using namespace spirv;
+    encoded.clear();
+    if (words.size() < HEADER_WORDS || words[0] != MAGIC)
+    {
+      return false;
+    }
+    encoded.reserve(words.size()*2);
+    appendVarint(encoded,words.size());
+    for (uint32_t i=0; i<HEADER_WORDS; ++i)
+    {
+      appendVarint(encoded,words[i]);
+    }
+    uint32_t lastResult = 0;
+    for (size_t position = HEADER_WORDS; position < words.size();)
+    {
+      uint32_t opcode = words[position] & 0xffff;
+      uint32_t wordCount = words[position] >> 16;
+      if (wordCount == 0 || wordCount > words.size() - position)
+      {
+        encoded.clear();
+        return false;
+      }
+      appendVarint(encoded,opcode << 4 | std::min(wordCount,INLINE_WORD_COUNT));
+      if (wordCount >= INLINE_WORD_COUNT)
+      {
+        appendVarint(encoded,wordCount - INLINE_WORD_COUNT);
+      }
+
+      auto flags = operandFlags(opcode);
+      auto operand = position + 1;
+      auto end = position + wordCount;
+      if ((flags & HAS_TYPE) && operand < end)
+      {
+        appendVarint(encoded,words[operand++]);
+      }
+      if ((flags & HAS_RESULT) && operand < end)
+      {
+        appendVarint(encoded,zigzag(words[operand] - lastResult));
+        lastResult = words[operand++];
+      }
+      for (auto first = operand; operand < end; ++operand)
+      {
+        bool isId = (flags & ID_OPERANDS) || ((flags & FIRST_ID_OPERAND) && operand == first);
+        appendVarint(encoded,isId ? zigzag(lastResult - words[operand]) : words[operand]);
+      }
+      position = end;
+    }
+    return true;
+  }
+
+  ///Number of words an encoded module decodes to, zero if it can't be read
+  inline size_t decodedSpirvSize(std::span<const std::byte> encoded)
+  {
+    spirv::VarintReader reader{.position = encoded.data(),.end = encoded.data() + encoded.size()};
+    uint32_t wordCount = 0;
+    return reader.read(wordCount) ? wordCount : 0;
+  }
+
+  ///Decompresses into words, which must hold exactly decodedSpirvSize() words. Returns false for malformed input
+  inline bool decodeSpirv(std::span<const std::byte> encoded, std::span<uint32_t> words)
+  {
+    using namespace spirv;
+    VarintReader reader{.position = encoded.data(),.end = encoded.data() + encoded.size()};
+    uint32_t wordCount = 0;
+    if (!reader.read(wordCount) || wordCount != words.size() || wordCount < HEADER_WORDS)
+    {
+      return false;
+    }
+    for (uint32_t i=0; i<HEADER_WORDS; ++i)
+    {
+      if (!reader.read(words[i]))
+      {
+        return false;
+      }
+    }
+    uint32_t lastResult = 0;
+    for (size_t position = HEADER_WORDS; position < words.size();)
+    {
+      uint32_t instruction = 0;
+      if (!reader.read(instruction))
+      {
+        return false;
+      }
+      uint32_t opcode = instruction >> 4;
+      uint32_t instructionWords = instruction & 0xf;
+      if (instructionWords == INLINE_WORD_COUNT)
+      {
+        uint32_t extra = 0;
+        if (!reader.read(extra) || extra > 0xffff - INLINE_WORD_COUNT)
+        {
+          return false;
+        }
+        instructionWords += extra;
+      }
+      if (instructionWords == 0 || instructionWords > words.size() - position || opcode > 0xffff)
+      {
+        return false;
+      }
+      words[position] = instructionWords << 16 | opcode;
+
+      auto flags = operandFlags(opcode);
+      auto operand = position + 1;
+      auto end = position + instructionWords;
+      uint32_t value = 0;
+      if ((flags & HAS_TYPE) && operand < end)
+      {
+        if (!reader.read(words[operand++]))
+        {
+          return false;
+        }
+      }
+      if ((flags & HAS_RESULT) && operand < end)
+      {
+        if (!reader.read(value))
+        {
+          return false;
+        }
+        lastResult += unzigzag(value);
+        words[operand++] = lastResult;
+      }
+      for (auto first = operand; operand < end; ++operand)
+      {
+        if (!reader.read(value))
+        {
+          return false;
+        }
+        bool isId = (flags & ID_OPERANDS) || ((flags & FIRST_ID_OPERAND) && operand == first);
+        words[operand] = isId ? lastResult - unzigzag(value) : value;
+      }
+      position = end;
+    }
+    return reader.position == reader.end;
+  }
+}
+
+#endif //SHADERFAX_SPIRVCODEC_H
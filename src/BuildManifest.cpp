@@ -0,0 +1,166 @@
+#include "BuildManifest.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "Hash.h"
+
+constexpr const char* MANIFEST_HEADER = "shaderfax-manifest 1";
+
+BuildManifest::BuildManifest(uint64_t optionsHash)
+{
+    _optionsHash = optionsHash;
+}
+
+bool BuildManifest::load(const std::filesystem::path& manifestFile)
+{
+    std::ifstream inFile(manifestFile);
+    if (!inFile.is_open())
+    {
+        return false;
+    }
+    std::string line;
+    if (!std::getline(inFile,line) || line != MANIFEST_HEADER)
+    {
+        return false;
+    }
+
+    std::map<std::string,ManifestEntry> entries;
+    ManifestEntry* current = nullptr;
+    bool optionsMatch = false;
+    try
+    {
+        while (std::getline(inFile,line))
+        {
+            std::istringstream stream(line);
+            std::string kind;
+            std::string hash;
+            stream >> kind >> hash;
+            if (kind == "options")
+            {
+                optionsMatch = std::stoull(hash,nullptr,16) == _optionsHash;
+            }
+            else if (kind == "module")
+            {
+                int hasOutput = 0;
+                std::string path;
+                stream >> hasOutput;
+                stream.get();
+                std::getline(stream,path);
+                current = &entries[path];
+                current->sourceHash = std::stoull(hash,nullptr,16);
+                current->hasOutput = hasOutput != 0;
+            }
+            else if (kind == "dependency" && current)
+            {
+                std::string path;
+                stream.get();
+                std::getline(stream,path);
+                current->dependencies.push_back({.path = path,.hash = std::stoull(hash,nullptr,16)});
+            }
+            else if (!kind.empty())
+            {
+                return false;
+            }
+        }
+    }
+    catch (const std::exception& e)
+    {
+        return false;
+    }
+    if (!optionsMatch)
+    {
+        return false;
+    }
+    _entries = std::move(entries);
+    return true;
+}
+
+bool BuildManifest::save(const std::filesystem::path& manifestFile)
+{
+    auto temporary = manifestFile;
+    temporary += ".tmp";
+    std::ofstream outFile(temporary, std::ios::trunc);
+    if (!outFile.is_open())
+    {
+        return false;
+    }
+    outFile << MANIFEST_HEADER << "\n";
+    outFile << "options " << hashToHex(_optionsHash) << "\n";
+    for (auto& kvPair: _entries)
+    {
+        auto& entry = kvPair.second;
+        outFile << "module " << hashToHex(entry.sourceHash) << " " << (entry.hasOutput ? 1 : 0) << " " << kvPair.first << "\n";
+        for (auto& dependency: entry.dependencies)
+        {
+            outFile << "dependency " << hashToHex(dependency.hash) << " " << dependency.path << "\n";
+        }
+    }
+    outFile.close();
+    if (!outFile)
+    {
+        return false;
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary,manifestFile,error);
+    return !error;
+}
+
+bool BuildManifest::hashFile(const std::filesystem::path& file, uint64_t& hash)
+{
+    auto key = absolute(file).lexically_normal().generic_string();
+    auto existing = _fileHashes.find(key);
+    if (existing != _fileHashes.end())
+    {
+        hash = existing->second;
+        return true;
+    }
+    if (!::hashFile(file,hash))
+    {
+        return false;
+    }
+    _fileHashes[key] = hash;
+    return true;
+}
+
+void BuildManifest::forgetFileHash(const std::filesystem::path& file)
+{
+    _fileHashes.erase(absolute(file).lexically_normal().generic_string());
+}
+
+const std::map<std::string,ManifestEntry>& BuildManifest::entries()
+{
+    return _entries;
+}
+
+ManifestEntry* BuildManifest::find(const std::string& relativeSource)
+{
+    auto entry = _entries.find(relativeSource);
+    if (entry == _entries.end())
+    {
+        return nullptr;
+    }
+    return &entry->second;
+}
+
+void BuildManifest::set(const std::string& relativeSource, ManifestEntry entry)
+{
+    _entries[relativeSource] = std::move(entry);
+}
+
+void BuildManifest::erase(const std::string& relativeSource)
+{
+    _entries.erase(relativeSource);
+}
+
+std::filesystem::path BuildManifest::manifestPathFor(const std::filesystem::path& output)
+{
+    auto folder = output.lexically_normal();
+    if (!folder.has_filename())
+    {
+        folder = folder.parent_path();
+    }
+    auto manifest = folder;
+    manifest += ".manifest";
+    return manifest;
+}
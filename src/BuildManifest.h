@@ -0,0 +1,49 @@
+#ifndef SHADERFAX_BUILDMANIFEST_H
+#define SHADERFAX_BUILDMANIFEST_H
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <vector>
+
+///A file a module was compiled from, and the hash of its contents at the time
+struct ManifestDependency
+{
+  std::string path;
+  uint64_t hash=0;
+};
+///What a single .slang file looked like the last time it was compiled
+struct ManifestEntry
+{
+  uint64_t sourceHash=0;
+  ///Whether the module defined entry points and therefore produced a .cshdr file
+  bool hasOutput=false;
+  ///Every file the module depended on, including imported modules
+  std::vector<ManifestDependency> dependencies;
+};
+
+///Record of the previous build, stored next to the output folder so unchanged modules can be skipped
+class BuildManifest
+{
+private:
+  uint64_t _optionsHash = 0;
+  std::map<std::string,ManifestEntry> _entries;
+  std::map<std::string,uint64_t> _fileHashes;
+public:
+  BuildManifest(uint64_t optionsHash);
+  ///Loads a previous manifest. Returns false if there is none, it can't be read, or it was built with different options
+  bool load(const std::filesystem::path& manifestFile);
+  bool save(const std::filesystem::path& manifestFile);
+  ///Hashes a file's contents, each file is only read once per manifest
+  bool hashFile(const std::filesystem::path& file, uint64_t& hash);
+  ///Drops a remembered file hash, so a file known to have changed is read again
+  void forgetFileHash(const std::filesystem::path& file);
+  const std::map<std::string,ManifestEntry>& entries();
+  ManifestEntry* find(const std::string& relativeSource);
+  void set(const std::string& relativeSource, ManifestEntry entry);
+  void erase(const std::string& relativeSource);
+
+  static std::filesystem::path manifestPathFor(const std::filesystem::path& output);
+};
+
+#endif //SHADERFAX_BUILDMANIFEST_H
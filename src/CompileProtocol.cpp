@@ -0,0 +1,314 @@
+#include "CompileProtocol.h"
+
+#include <cstring>
+#include <string_view>
+#include <boost/endian/conversion.hpp>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+template<typename T>
+void appendValue(std::vector<char>& message, T value);
+void appendString(std::vector<char>& message, std::string_view text);
+bool sendMessage(int socket, std::vector<char>& message);
+bool receiveMessage(int socket, std::vector<char>& message);
+
+///Bounds checked reader of the fields of a message
+struct MessageReader
+{
+    const char* position;
+    const char* end;
+    template<typename T>
+    bool read(T& value)
+    {
+        if (end - position < (ptrdiff_t)sizeof(T))
+        {
+            return false;
+        }
+        std::memcpy(&value,position,sizeof(T));
+        boost::endian::little_to_native_inplace(value);
+        position += sizeof(T);
+        return true;
+    }
+    bool read(std::string& text)
+    {
+        uint32_t size = 0;
+        if (!read(size) || end - position < (ptrdiff_t)size)
+        {
+            return false;
+        }
+        text.assign(position,size);
+        position += size;
+        return true;
+    }
+};
+
+bool sendRequest(int socket, const CompileRequest& request)
+{
+    std::vector<char> message(sizeof(uint32_t));
+    appendString(message,request.path);
+    appendString(message,request.source);
+    appendValue<uint32_t>(message,request.macros.size());
+    for (auto& macro: request.macros)
+    {
+        appendString(message,macro.name);
+        appendString(message,macro.value);
+    }
+    return sendMessage(socket,message);
+}
+
+bool receiveRequest(int socket, CompileRequest& request)
+{
+    std::vector<char> message;
+    if (!receiveMessage(socket,message))
+    {
+        return false;
+    }
+    MessageReader reader{.position = message.data(),.end = message.data() + message.size()};
+    uint32_t macroCount = 0;
+    if (!reader.read(request.path) || !reader.read(request.source) || !reader.read(macroCount))
+    {
+        return false;
+    }
+    request.macros.clear();
+    for (uint32_t i=0; i<macroCount; ++i)
+    {
+        ShaderMacro macro;
+        if (!reader.read(macro.name) || !reader.read(macro.value))
+        {
+            return false;
+        }
+        request.macros.push_back(std::move(macro));
+    }
+    return reader.position == reader.end;
+}
+
+bool sendResponse(int socket, const CompileResponse& response)
+{
+    std::vector<char> message(sizeof(uint32_t));
+    appendValue<uint32_t>(message,response.success);
+    appendValue<uint64_t>(message,response.microseconds);
+    appendString(message,response.diagnostics);
+    appendString(message,std::string_view(response.file.data(),response.file.size()));
+    return sendMessage(socket,message);
+}
+
+bool receiveResponse(int socket, CompileResponse& response)
+{
+    std::vector<char> message;
+    if (!receiveMessage(socket,message))
+    {
+        return false;
+    }
+    MessageReader reader{.position = message.data(),.end = message.data() + message.size()};
+    uint32_t success = 0;
+    std::string file;
+    if (!reader.read(success) || !reader.read(response.microseconds) || !reader.read(response.diagnostics) || !reader.read(file))
+    {
+        return false;
+    }
+    response.success = success == 1;
+    response.file.assign(file.begin(),file.end());
+    return reader.position == reader.end;
+}
+
+template<typename T>
+void appendValue(std::vector<char>& message, T value)
+{
+    boost::endian::native_to_little_inplace(value);
+    auto bytes = (const char*)&value;
+    message.insert(message.end(),bytes,bytes + sizeof(T));
+}
+
+void appendString(std::vector<char>& message, std::string_view text)
+{
+    appendValue<uint32_t>(message,text.size());
+    message.insert(message.end(),text.begin(),text.end());
+}
+
+#ifndef _WIN32
+
+//macOS has no MSG_NOSIGNAL, processes sending there ignore SIGPIPE instead
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+bool socketAddress(const std::filesystem::path& path, sockaddr_un& address);
+bool receiveBytes(int socket, char* data, size_t size);
+
+bool socketAddress(const std::filesystem::path& path, sockaddr_un& address)
+{
+    address = {};
+    address.sun_family = AF_UNIX;
+    auto& name = path.native();
+    if (name.size() >= sizeof(address.sun_path))
+    {
+        return false;
+    }
+    std::memcpy(address.sun_path,name.c_str(),name.size() + 1);
+    return true;
+}
+
+int listenOnSocket(const std::filesystem::path& path)
+{
+    sockaddr_un address;
+    if (!socketAddress(path,address))
+    {
+        return -1;
+    }
+    //a socket nobody accepts on is left over from a server that stopped
+    if (std::filesystem::exists(path))
+    {
+        int running = connectToSocket(path);
+        if (running >= 0)
+        {
+            closeSocket(running);
+            return -1;
+        }
+        std::error_code error;
+        std::filesystem::remove(path,error);
+    }
+    int descriptor = socket(AF_UNIX,SOCK_STREAM,0);
+    if (descriptor < 0)
+    {
+        return -1;
+    }
+    if (bind(descriptor,(sockaddr*)&address,sizeof(address)) != 0 || listen(descriptor,SOMAXCONN) != 0)
+    {
+        close(descriptor);
+        return -1;
+    }
+    return descriptor;
+}
+
+int acceptConnection(int listener)
+{
+    while (true)
+    {
+        int connection = accept(listener,nullptr,nullptr);
+        if (connection >= 0 || (errno != EINTR && errno != ECONNABORTED))
+        {
+            return connection;
+        }
+    }
+}
+
+int connectToSocket(const std::filesystem::path& path)
+{
+    sockaddr_un address;
+    if (!socketAddress(path,address))
+    {
+        return -1;
+    }
+    int descriptor = socket(AF_UNIX,SOCK_STREAM,0);
+    if (descriptor < 0)
+    {
+        return -1;
+    }
+    if (connect(descriptor,(sockaddr*)&address,sizeof(address)) != 0)
+    {
+        close(descriptor);
+        return -1;
+    }
+    return descriptor;
+}
+
+void closeSocket(int socket)
+{
+    close(socket);
+}
+
+bool sendMessage(int socket, std::vector<char>& message)
+{
+    uint32_t size = message.size() - sizeof(uint32_t);
+    boost::endian::native_to_little_inplace(size);
+    std::memcpy(message.data(),&size,sizeof(size));
+    size_t sent = 0;
+    while (sent < message.size())
+    {
+        //a client that went away fails the send instead of raising SIGPIPE
+        auto count = send(socket,message.data() + sent,message.size() - sent,MSG_NOSIGNAL);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            return false;
+        }
+        sent += count;
+    }
+    return true;
+}
+
+bool receiveBytes(int socket, char* data, size_t size)
+{
+    size_t received = 0;
+    while (received < size)
+    {
+        auto count = recv(socket,data + received,size - received,0);
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            return false;
+        }
+        received += count;
+    }
+    return true;
+}
+
+bool receiveMessage(int socket, std::vector<char>& message)
+{
+    uint32_t size = 0;
+    if (!receiveBytes(socket,(char*)&size,sizeof(size)))
+    {
+        return false;
+    }
+    boost::endian::little_to_native_inplace(size);
+    if (size > MAX_MESSAGE_SIZE)
+    {
+        return false;
+    }
+    message.resize(size);
+    return receiveBytes(socket,message.data(),size);
+}
+
+#else
+
+int listenOnSocket(const std::filesystem::path& path)
+{
+    return -1;
+}
+
+int acceptConnection(int listener)
+{
+    return -1;
+}
+
+int connectToSocket(const std::filesystem::path& path)
+{
+    return -1;
+}
+
+void closeSocket(int socket)
+{
+}
+
+bool sendMessage(int socket, std::vector<char>& message)
+{
+    return false;
+}
+
+bool receiveMessage(int socket, std::vector<char>& message)
+{
+    return false;
+}
+
+#endif
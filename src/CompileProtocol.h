@@ -0,0 +1,51 @@
+#ifndef SHADERFAX_COMPILEPROTOCOL_H
+#define SHADERFAX_COMPILEPROTOCOL_H
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "VariantMatrix.h"
+
+///Messages of the compile server, exchanged over a Unix stream socket. Every message is a uint32_t size followed by that
+///many bytes of fields. Integers are little endian, strings are a uint32_t size followed by their bytes. A connection may
+///send any number of requests, each is answered before the next one is read.
+///
+///A request is the module path, the source, the number of macros and the name and value of every macro. An empty source
+///compiles the module at path under the server's root, otherwise the source is compiled as if it were that module. The
+///macros pick a single variant, a variant matrix the module declares isn't expanded.
+///A response is a uint32_t that is 1 on success, the uint64_t microseconds the server spent on the request, the
+///diagnostics and the .cshdr file, which is empty for modules without entry points
+
+///Messages larger than this are refused, so a bad size can't make either side allocate without bound
+constexpr uint32_t MAX_MESSAGE_SIZE = 512*1024*1024;
+
+struct CompileRequest
+{
+  std::string path;
+  std::string source;
+  std::vector<ShaderMacro> macros;
+};
+
+struct CompileResponse
+{
+  bool success = false;
+  uint64_t microseconds = 0;
+  std::string diagnostics;
+  std::vector<char> file;
+};
+
+///Listens on a socket at path, replacing a socket left behind by a server that stopped. Returns -1 on failure
+int listenOnSocket(const std::filesystem::path& path);
+///Waits for the next connection to a listening socket, returns -1 on failure
+int acceptConnection(int listener);
+///Returns -1 on failure
+int connectToSocket(const std::filesystem::path& path);
+void closeSocket(int socket);
+bool sendRequest(int socket, const CompileRequest& request);
+///Returns false once the peer closed the connection or sent a malformed message
+bool receiveRequest(int socket, CompileRequest& request);
+bool sendResponse(int socket, const CompileResponse& response);
+bool receiveResponse(int socket, CompileResponse& response);
+
+#endif //SHADERFAX_COMPILEPROTOCOL_H
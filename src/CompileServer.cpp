@@ -0,0 +1,172 @@
+#include "CompileServer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#include "Hash.h"
+#include "SpirvStrip.h"
+using namespace slang;
+
+///Distinct inline sources a session holds before it is replaced, as slang can't unload a module once it is loaded
+constexpr size_t MAX_INLINE_SOURCES = 64;
+
+CompileServer::CompileServer(const std::filesystem::path& root, const CompileSettings& settings, ShaderFileFormat format, shaderfax::BlobEncoding encoding, bool stripDebugInfo, unsigned int compilerCount)
+{
+    _root = root;
+    _format = format;
+    _encoding = encoding;
+    _stripDebugInfo = stripDebugInfo;
+    //global sessions take long to create, so every compiler is ready before the first request
+    for (auto i=0; i<std::max(1u,compilerCount); ++i)
+    {
+        auto pooled = std::make_unique<PooledCompiler>();
+        pooled->compiler = std::make_unique<ShaderCompiler>(root,settings);
+        _idle.push_back(std::move(pooled));
+    }
+}
+
+bool CompileServer::serve(const std::filesystem::path& socket)
+{
+#ifndef _WIN32
+    //clients that disconnect before their answer is sent only fail that send
+    std::signal(SIGPIPE,SIG_IGN);
+#endif
+    int listener = listenOnSocket(socket);
+    if (listener < 0)
+    {
+        std::cerr << "Unable to listen on "<<socket<<", another server may be using it\n";
+        return false;
+    }
+    std::cout << "Serving compile requests for "<<_root<<" on "<<socket<<std::endl;
+    for (int connection = acceptConnection(listener); connection >= 0; connection = acceptConnection(listener))
+    {
+        {
+            std::lock_guard lock(_mutex);
+            ++_connections;
+        }
+        std::thread([this,connection]()
+        {
+            serveConnection(connection);
+            closeSocket(connection);
+            std::lock_guard lock(_mutex);
+            --_connections;
+            _changed.notify_all();
+        }).detach();
+    }
+    closeSocket(listener);
+    std::cerr << "Stopped accepting connections on "<<socket<<"\n";
+    std::unique_lock lock(_mutex);
+    _changed.wait(lock,[&](){return _connections == 0;});
+    return true;
+}
+
+void CompileServer::serveConnection(int socket)
+{
+    CompileRequest request;
+    while (receiveRequest(socket,request))
+    {
+        std::unique_ptr<PooledCompiler> pooled;
+        {
+            std::unique_lock lock(_mutex);
+            _changed.wait(lock,[&](){return !_idle.empty();});
+            //changing the macros of a compiler replaces its session, so the one unused the longest is switched over
+            auto chosen = std::find_if(_idle.begin(),_idle.end(),[&](const std::unique_ptr<PooledCompiler>& idle){return idle->macros == request.macros;});
+            if (chosen == _idle.end())
+            {
+                chosen = std::min_element(_idle.begin(),_idle.end(),[](const std::unique_ptr<PooledCompiler>& a, const std::unique_ptr<PooledCompiler>& b){return a->lastUsed < b->lastUsed;});
+            }
+            pooled = std::move(*chosen);
+            _idle.erase(chosen);
+            pooled->lastUsed = ++_requestCount;
+        }
+        CompileResponse response;
+        compile(*pooled,request,response);
+        {
+            std::lock_guard lock(_mutex);
+            _idle.push_back(std::move(pooled));
+            _changed.notify_all();
+            std::cout << request.path << (response.success ? "" : " failed") << " in "<<response.microseconds/1000.0<<"ms"<<std::endl;
+        }
+        if (!sendResponse(socket,response))
+        {
+            return;
+        }
+    }
+}
+
+void CompileServer::compile(PooledCompiler& pooled, const CompileRequest& request, CompileResponse& response)
+{
+    auto start = std::chrono::steady_clock::now();
+    auto& compiler = *pooled.compiler;
+    //sessions keep every module they loaded, which is stale once a file any of them was read from changed
+    bool stale = false;
+    for (auto& [file,time]: pooled.files)
+    {
+        std::error_code error;
+        if (std::filesystem::last_write_time(file,error) != time)
+        {
+            stale = true;
+            break;
+        }
+    }
+    //every edit of an inline source loads another module, which would grow a long running server without bound
+    uint64_t sourceHash = request.source.empty() ? 0 : hashString(request.source,hashString(request.path));
+    if (sourceHash != 0 && !pooled.inlineSources.contains(sourceHash) && pooled.inlineSources.size() >= MAX_INLINE_SOURCES)
+    {
+        stale = true;
+    }
+    if (request.macros != pooled.macros)
+    {
+        //new macros replace the session as well
+        compiler.setMacros(request.macros);
+        pooled.macros = request.macros;
+        stale = true;
+    }
+    else if (stale)
+    {
+        compiler.resetSession();
+    }
+    if (stale)
+    {
+        pooled.files.clear();
+        pooled.inlineSources.clear();
+    }
+    if (sourceHash != 0)
+    {
+        pooled.inlineSources.insert(sourceHash);
+    }
+
+    std::ostringstream errors;
+    IModule* module = nullptr;
+    response.success = request.source.empty() ? compiler.loadModule(request.path,module,errors) : compiler.loadModuleFromSource(request.path,request.source,module,errors);
+    if (response.success && module)
+    {
+        std::vector<std::filesystem::path> dependencies;
+        ShaderCompiler::getDependencies(module,dependencies);
+        for (auto& file: dependencies)
+        {
+            std::error_code error;
+            pooled.files.emplace(file,std::filesystem::last_write_time(file,error));
+        }
+        ShaderFileData fileData;
+        if (module->getDefinedEntryPointCount() > 0)
+        {
+            response.success = compiler.compileModule(module,fileData,errors);
+        }
+        if (response.success && !fileData.shaderOutData.empty())
+        {
+            if (_stripDebugInfo)
+            {
+                stripFileCode(fileData);
+            }
+            ShaderFileWriter writer(fileData,_format,_encoding);
+            writer.copyTo(response.file);
+        }
+    }
+    response.diagnostics = errors.str();
+    response.microseconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
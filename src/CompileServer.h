@@ -0,0 +1,57 @@
+#ifndef SHADERFAX_COMPILESERVER_H
+#define SHADERFAX_COMPILESERVER_H
+#include <condition_variable>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+#include <shaderfax/CshdrFormat.h>
+
+#include "CompileProtocol.h"
+#include "ShaderCompiler.h"
+#include "ShaderFileWriter.h"
+
+///Answers compile requests of running engines on a Unix socket, see CompileProtocol.h. Each connection is served on its
+///own thread and requests run concurrently on a pool of compilers. Compilers keep their global session and the modules they
+///loaded between requests, until a file those modules were read from changes or too many inline sources were loaded.
+///Requests go to a compiler already set up for their macros when one is idle, so alternating macro sets don't keep
+///replacing sessions
+class CompileServer
+{
+private:
+  struct PooledCompiler
+  {
+    std::unique_ptr<ShaderCompiler> compiler;
+    ///Modification time of every file the modules of the session were read from
+    std::map<std::filesystem::path,std::filesystem::file_time_type> files;
+    ///Hashes of the inline sources loaded into the session, every one of them stays loaded until the session is replaced
+    std::unordered_set<uint64_t> inlineSources;
+    ///Macros of the session
+    std::vector<ShaderMacro> macros;
+    ///Request count when the compiler was last taken from the pool
+    uint64_t lastUsed = 0;
+  };
+  std::filesystem::path _root;
+  ShaderFileFormat _format;
+  shaderfax::BlobEncoding _encoding;
+  bool _stripDebugInfo;
+  std::mutex _mutex;
+  std::condition_variable _changed;
+  ///Compilers not serving a request
+  std::vector<std::unique_ptr<PooledCompiler>> _idle;
+  size_t _connections = 0;
+  uint64_t _requestCount = 0;
+  void serveConnection(int socket);
+  void compile(PooledCompiler& pooled, const CompileRequest& request, CompileResponse& response);
+public:
+  ///Files are written like builds with the same options write them, compilerCount requests are compiled at a time
+  CompileServer(const std::filesystem::path& root, const CompileSettings& settings, ShaderFileFormat format, shaderfax::BlobEncoding encoding, bool stripDebugInfo, unsigned int compilerCount);
+  ///Accepts connections until accepting fails, then waits for the open connections to close. Returns false if it can't
+  ///listen on the socket
+  bool serve(const std::filesystem::path& socket);
+};
+
+#endif //SHADERFAX_COMPILESERVER_H
@@ -0,0 +1,168 @@
+#include "DependencyGraph.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include "Json.h"
+
+std::string displayPath(const std::string& file, const std::filesystem::path& absoluteRoot);
+
+DependencyGraph::DependencyGraph(BuildManifest& manifest, const std::filesystem::path& root)
+{
+    for (auto& kvPair: manifest.entries())
+    {
+        addModule(kvPair.first,root,kvPair.second);
+    }
+}
+
+void DependencyGraph::addEdge(const std::string& module, const std::string& file, uint64_t hash)
+{
+    auto& dependencies = _modules[module];
+    if (std::find(dependencies.begin(),dependencies.end(),file) != dependencies.end())
+    {
+        return;
+    }
+    dependencies.push_back(file);
+
+    auto& node = _files[file];
+    if (!node.dependents.empty() && node.hash != hash)
+    {
+        node.conflicting = true;
+    }
+    node.hash = hash;
+    node.dependents.insert(module);
+}
+
+void DependencyGraph::addModule(const std::string& module, const std::filesystem::path& root, const ManifestEntry& entry)
+{
+    removeModule(module);
+    addEdge(module,absolute(root/module).generic_string(),entry.sourceHash);
+    for (auto& dependency: entry.dependencies)
+    {
+        addEdge(module,dependency.path,dependency.hash);
+    }
+}
+
+void DependencyGraph::removeModule(const std::string& module)
+{
+    auto existing = _modules.find(module);
+    if (existing == _modules.end())
+    {
+        return;
+    }
+    for (auto& file: existing->second)
+    {
+        auto node = _files.find(file);
+        node->second.dependents.erase(module);
+        if (node->second.dependents.empty())
+        {
+            _files.erase(node);
+        }
+    }
+    _modules.erase(existing);
+}
+
+std::set<std::string> DependencyGraph::dependentsOf(const std::vector<std::string>& files)
+{
+    std::set<std::string> modules;
+    for (auto& file: files)
+    {
+        auto node = _files.find(file);
+        if (node != _files.end())
+        {
+            modules.insert(node->second.dependents.begin(),node->second.dependents.end());
+        }
+    }
+    return modules;
+}
+
+std::vector<std::string> DependencyGraph::changedFiles(BuildManifest& manifest)
+{
+    std::vector<std::string> changed;
+    for (auto& kvPair: _files)
+    {
+        uint64_t hash = 0;
+        if (kvPair.second.conflicting || !manifest.hashFile(kvPair.first,hash) || hash != kvPair.second.hash)
+        {
+            changed.push_back(kvPair.first);
+        }
+    }
+    return changed;
+}
+
+const std::map<std::string,DependencyNode>& DependencyGraph::files()
+{
+    return _files;
+}
+
+bool DependencyGraph::writeJson(const std::filesystem::path& jsonFile, const std::filesystem::path& root)
+{
+    std::ofstream outFile(jsonFile, std::ios::trunc);
+    if (!outFile.is_open())
+    {
+        return false;
+    }
+    auto absoluteRoot = absolute(root).lexically_normal();
+
+    outFile << "{\n  \"modules\": {";
+    bool first = true;
+    for (auto& kvPair: _modules)
+    {
+        outFile << (first ? "\n    " : ",\n    ");
+        first = false;
+        writeJsonString(outFile,kvPair.first);
+        outFile << ": [";
+        for (auto i=0; i<kvPair.second.size(); ++i)
+        {
+            if (i > 0)
+            {
+                outFile << ", ";
+            }
+            writeJsonString(outFile,displayPath(kvPair.second[i],absoluteRoot));
+        }
+        outFile << "]";
+    }
+    outFile << "\n  },\n  \"files\": [";
+
+    std::vector<const std::pair<const std::string,DependencyNode>*> byFanOut;
+    for (auto& kvPair: _files)
+    {
+        byFanOut.push_back(&kvPair);
+    }
+    std::stable_sort(byFanOut.begin(),byFanOut.end(),[](auto a, auto b){return a->second.dependents.size() > b->second.dependents.size();});
+
+    first = true;
+    for (auto file: byFanOut)
+    {
+        outFile << (first ? "\n    " : ",\n    ");
+        first = false;
+        outFile << "{\"path\": ";
+        writeJsonString(outFile,displayPath(file->first,absoluteRoot));
+        outFile << ", \"fanOut\": " << file->second.dependents.size() << ", \"dependents\": [";
+        bool firstDependent = true;
+        for (auto& dependent: file->second.dependents)
+        {
+            if (!firstDependent)
+            {
+                outFile << ", ";
+            }
+            firstDependent = false;
+            writeJsonString(outFile,dependent);
+        }
+        outFile << "]}";
+    }
+    outFile << "\n  ]\n}\n";
+    outFile.close();
+    return !outFile.fail();
+}
+
+std::string displayPath(const std::string& file, const std::filesystem::path& absoluteRoot)
+{
+    auto path = std::filesystem::path(file).lexically_normal();
+    auto relative = path.lexically_relative(absoluteRoot);
+    if (relative.empty() || *relative.begin() == "..")
+    {
+        return path.generic_string();
+    }
+    return relative.generic_string();
+}
@@ -0,0 +1,45 @@
+#ifndef SHADERFAX_DEPENDENCYGRAPH_H
+#define SHADERFAX_DEPENDENCYGRAPH_H
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "BuildManifest.h"
+
+///A source file some module was compiled from
+struct DependencyNode
+{
+  ///Hash of the file when its dependents were last compiled
+  uint64_t hash=0;
+  ///Dependents recorded different hashes for this file, so it has to be treated as changed
+  bool conflicting=false;
+  ///Relative paths of every module compiled from this file
+  std::set<std::string> dependents;
+};
+
+///Which files each module was compiled from, and the reverse: which modules each file feeds into
+class DependencyGraph
+{
+private:
+  std::map<std::string,std::vector<std::string>> _modules;
+  std::map<std::string,DependencyNode> _files;
+  void addEdge(const std::string& module, const std::string& file, uint64_t hash);
+public:
+  DependencyGraph() = default;
+  ///Builds the graph out of every module recorded in the manifest
+  DependencyGraph(BuildManifest& manifest, const std::filesystem::path& root);
+  void addModule(const std::string& module, const std::filesystem::path& root, const ManifestEntry& entry);
+  void removeModule(const std::string& module);
+  ///Every module compiled from at least one of the files
+  std::set<std::string> dependentsOf(const std::vector<std::string>& files);
+  ///Files whose current contents no longer match what their dependents were compiled from
+  std::vector<std::string> changedFiles(BuildManifest& manifest);
+  const std::map<std::string,DependencyNode>& files();
+  ///Dumps modules with their dependencies, and files ordered by how many modules they fan out to
+  bool writeJson(const std::filesystem::path& jsonFile, const std::filesystem::path& root);
+};
+
+#endif //SHADERFAX_DEPENDENCYGRAPH_H
@@ -1,10 +1,21 @@
 #include "DescriptorSet.h"
 
+#include <algorithm>
 #include <stdexcept>
 
-void DescriptorSet::addAutomaticallyIntroducedUniformBuffer(const char* name)
+#include <shaderfax/CshdrFormat.h>
+
+///Appends every field of a struct with uniform data, flattening nested structs. Fields inside an array of structs repeat
+///every arrayStride bytes
+void addUniformMembers(std::vector<UniformMember>& members, slang::TypeLayoutReflection* typeLayout, const std::string& prefix, size_t offset, size_t arrayCount, size_t arrayStride);
+UniformMember getUniformMember(const std::string& name, slang::TypeLayoutReflection* typeLayout, size_t offset, size_t arrayCount, size_t arrayStride);
+uint32_t getUniformType(slang::TypeReflection::ScalarType scalarType);
+
+void DescriptorSet::addAutomaticallyIntroducedUniformBuffer(const char* name, slang::TypeLayoutReflection* typeLayout)
 {
-    _descriptors.push_back({.name=name,.type = UNIFORM_BUFFER,.index = 0,.count = 1});
+    Descriptor descriptor{.name=name,.type = UNIFORM_BUFFER,.index = 0,.count = 1,.size = typeLayout->getSize()};
+    addUniformMembers(descriptor.members,typeLayout,"",0,1,0);
+    _descriptors.push_back(std::move(descriptor));
 }
 
 void DescriptorSet::addDescriptorRanges(slang::TypeLayoutReflection* typeLayout)
@@ -86,12 +97,18 @@ DescriptorSet::DescriptorSet(const char* name, slang::TypeLayoutReflection* elem
 
     if(elementTypeLayout->getSize() > 0)
     {
-        addAutomaticallyIntroducedUniformBuffer(name);
+        addAutomaticallyIntroducedUniformBuffer(name,elementTypeLayout);
     }
 
     addDescriptorRanges(elementTypeLayout);
 }
 
+DescriptorSet::DescriptorSet(size_t index, std::vector<Descriptor> descriptors)
+{
+    _index = index;
+    _descriptors = std::move(descriptors);
+}
+
 size_t DescriptorSet::descriptorCount()
 {
     return _descriptors.size();
@@ -106,3 +123,101 @@ size_t DescriptorSet::index()
 {
     return _index;
 }
+
+void addUniformMembers(std::vector<UniformMember>& members, slang::TypeLayoutReflection* typeLayout, const std::string& prefix, size_t offset, size_t arrayCount, size_t arrayStride)
+{
+    for (unsigned i=0; i<typeLayout->getFieldCount(); ++i)
+    {
+        auto field = typeLayout->getFieldByIndex(i);
+        auto fieldLayout = field->getTypeLayout();
+        //resources take no uniform bytes, they are bound as descriptors of their own
+        if (fieldLayout->getSize() == 0)
+        {
+            continue;
+        }
+        auto name = prefix + field->getName();
+        auto fieldOffset = offset + field->getOffset();
+        switch (fieldLayout->getKind())
+        {
+            case slang::TypeReflection::Kind::Struct:
+                addUniformMembers(members,fieldLayout,name + ".",fieldOffset,arrayCount,arrayStride);
+                break;
+            case slang::TypeReflection::Kind::Array:
+                //an array inside an array of structs is copied whole with the outer stride
+                if (arrayCount == 1)
+                {
+                    auto elementLayout = fieldLayout->getElementTypeLayout();
+                    auto count = std::max<size_t>(1,fieldLayout->getElementCount());
+                    auto stride = fieldLayout->getElementStride(slang::ParameterCategory::Uniform);
+                    if (elementLayout->getKind() == slang::TypeReflection::Kind::Struct)
+                    {
+                        addUniformMembers(members,elementLayout,name + ".",fieldOffset,count,stride);
+                    }
+                    else
+                    {
+                        members.push_back(getUniformMember(name,elementLayout,fieldOffset,count,stride));
+                    }
+                    break;
+                }
+                [[fallthrough]];
+            default:
+                members.push_back(getUniformMember(name,fieldLayout,fieldOffset,arrayCount,arrayStride));
+                break;
+        }
+    }
+}
+
+UniformMember getUniformMember(const std::string& name, slang::TypeLayoutReflection* typeLayout, size_t offset, size_t arrayCount, size_t arrayStride)
+{
+    UniformMember member{.name = name,.offset = (uint32_t)offset,.size = (uint32_t)typeLayout->getSize(),.arrayCount = (uint32_t)arrayCount,.arrayStride = (uint32_t)arrayStride};
+    auto type = typeLayout->getType();
+    switch (typeLayout->getKind())
+    {
+        case slang::TypeReflection::Kind::Scalar:
+            member.rows = 1;
+            member.columns = 1;
+            break;
+        case slang::TypeReflection::Kind::Vector:
+        case slang::TypeReflection::Kind::Matrix:
+            member.rows = type->getRowCount();
+            member.columns = type->getColumnCount();
+            break;
+        default:
+            return member;
+    }
+    member.type = getUniformType(type->getScalarType());
+    return member;
+}
+
+uint32_t getUniformType(slang::TypeReflection::ScalarType scalarType)
+{
+    switch (scalarType)
+    {
+        case slang::TypeReflection::ScalarType::Bool:
+            return shaderfax::UNIFORM_TYPE_BOOL;
+        case slang::TypeReflection::ScalarType::Int8:
+            return shaderfax::UNIFORM_TYPE_INT8;
+        case slang::TypeReflection::ScalarType::UInt8:
+            return shaderfax::UNIFORM_TYPE_UINT8;
+        case slang::TypeReflection::ScalarType::Int16:
+            return shaderfax::UNIFORM_TYPE_INT16;
+        case slang::TypeReflection::ScalarType::UInt16:
+            return shaderfax::UNIFORM_TYPE_UINT16;
+        case slang::TypeReflection::ScalarType::Int32:
+            return shaderfax::UNIFORM_TYPE_INT32;
+        case slang::TypeReflection::ScalarType::UInt32:
+            return shaderfax::UNIFORM_TYPE_UINT32;
+        case slang::TypeReflection::ScalarType::Int64:
+            return shaderfax::UNIFORM_TYPE_INT64;
+        case slang::TypeReflection::ScalarType::UInt64:
+            return shaderfax::UNIFORM_TYPE_UINT64;
+        case slang::TypeReflection::ScalarType::Float16:
+            return shaderfax::UNIFORM_TYPE_FLOAT16;
+        case slang::TypeReflection::ScalarType::Float32:
+            return shaderfax::UNIFORM_TYPE_FLOAT32;
+        case slang::TypeReflection::ScalarType::Float64:
+            return shaderfax::UNIFORM_TYPE_FLOAT64;
+        default:
+            return shaderfax::UNIFORM_TYPE_UNKNOWN;
+    }
+}
@@ -1,5 +1,6 @@
 #ifndef SHADERFAX_DESCRIPTORSET_H
 #define SHADERFAX_DESCRIPTORSET_H
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -29,23 +30,41 @@ enum DescriptorType
   ///Object that is used in ray tracing and intersection testing
   ACCELERATION_STRUCTURE
 };
+///Field of a uniform buffer, see shaderfax::UniformMemberRecord
+struct UniformMember
+{
+  std::string name;
+  uint32_t offset = 0;
+  uint32_t size = 0;
+  ///Value of shaderfax::UniformType
+  uint32_t type = 0;
+  uint16_t rows = 0;
+  uint16_t columns = 0;
+  uint32_t arrayCount = 1;
+  uint32_t arrayStride = 0;
+  bool operator==(const UniformMember&) const = default;
+};
 struct Descriptor
 {
   std::string name;
   DescriptorType type=UNIFORM_BUFFER;
   size_t index=0;
   size_t count=0;
+  ///Bytes and fields of the uniform buffer holding the set's ordinary data, zero and empty for every other descriptor
+  size_t size=0;
+  std::vector<UniformMember> members;
 };
 class DescriptorSet 
 {
 private:
   size_t _index = SIZE_MAX;
   std::vector<Descriptor> _descriptors;
-  void addAutomaticallyIntroducedUniformBuffer(const char* name);
+  void addAutomaticallyIntroducedUniformBuffer(const char* name, slang::TypeLayoutReflection* typeLayout);
   void addDescriptorRanges(slang::TypeLayoutReflection* typeLayout);
   void addDescriptorRange(slang::TypeLayoutReflection* typeLayout,int relativeSetIndex,int rangeIndex);
 public:
   DescriptorSet(const char* name,slang::TypeLayoutReflection* elementTypeLayout, size_t index);
+  DescriptorSet(size_t index, std::vector<Descriptor> descriptors);
   size_t descriptorCount();
   Descriptor& at(size_t index);
   size_t index();
@@ -0,0 +1,164 @@
+#include "FileWatcher.h"
+
+void FileWatcher::ignore(const std::filesystem::path& path)
+{
+    _ignored.push_back(absolute(path).lexically_normal());
+}
+
+bool FileWatcher::isIgnored(const std::filesystem::path& path)
+{
+    auto normal = absolute(path).lexically_normal();
+    for (auto& ignored: _ignored)
+    {
+        auto temporary = ignored;
+        temporary += ".tmp";
+        auto relative = normal.lexically_relative(ignored);
+        if (normal == temporary || (!relative.empty() && *relative.begin() != ".."))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+constexpr uint32_t WATCH_EVENTS = IN_CLOSE_WRITE|IN_CREATE|IN_DELETE|IN_MOVED_FROM|IN_MOVED_TO;
+
+FileWatcher::FileWatcher(const std::filesystem::path& root)
+{
+    _descriptor = inotify_init1(IN_CLOEXEC);
+    if (_descriptor >= 0)
+    {
+        addDirectory(absolute(root).lexically_normal());
+    }
+}
+
+FileWatcher::~FileWatcher()
+{
+    if (_descriptor >= 0)
+    {
+        close(_descriptor);
+    }
+}
+
+void FileWatcher::addDirectory(const std::filesystem::path& directory)
+{
+    int watch = inotify_add_watch(_descriptor,directory.c_str(),WATCH_EVENTS);
+    if (watch >= 0)
+    {
+        _watches[watch] = directory;
+    }
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(directory,error))
+    {
+        if (entry.is_directory(error) && !entry.is_symlink(error))
+        {
+            addDirectory(entry.path());
+        }
+    }
+}
+
+bool FileWatcher::isValid()
+{
+    return _descriptor >= 0 && !_watches.empty();
+}
+
+bool FileWatcher::waitForChanges(std::vector<std::filesystem::path>& changed, std::chrono::milliseconds debounce)
+{
+    pollfd request{.fd = _descriptor,.events = POLLIN,.revents = 0};
+    int timeout = -1;
+    while (true)
+    {
+        int ready = poll(&request,1,timeout);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        if (ready == 0)
+        {
+            return true;
+        }
+
+        alignas(inotify_event) char buffer[16*1024];
+        auto length = read(_descriptor,buffer,sizeof(buffer));
+        if (length <= 0)
+        {
+            if (length < 0 && (errno == EINTR || errno == EAGAIN))
+            {
+                continue;
+            }
+            return false;
+        }
+        for (char* position = buffer; position < buffer + length;)
+        {
+            auto event = (inotify_event*)position;
+            position += sizeof(inotify_event) + event->len;
+
+            auto watch = _watches.find(event->wd);
+            if (watch == _watches.end())
+            {
+                continue;
+            }
+            if (event->mask & IN_IGNORED)
+            {
+                _watches.erase(watch);
+                continue;
+            }
+            auto path = event->len ? watch->second/event->name : watch->second;
+            if (isIgnored(path))
+            {
+                continue;
+            }
+            if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE|IN_MOVED_TO)))
+            {
+                //a folder moved in brings its files along without any events of their own
+                addDirectory(path);
+                std::error_code error;
+                for (const auto& entry : std::filesystem::recursive_directory_iterator(path,error))
+                {
+                    if (!isIgnored(entry.path()))
+                    {
+                        changed.push_back(entry.path());
+                    }
+                }
+            }
+            changed.push_back(path);
+        }
+        timeout = debounce.count();
+    }
+}
+
+#else
+
+FileWatcher::FileWatcher(const std::filesystem::path& root)
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+}
+
+void FileWatcher::addDirectory(const std::filesystem::path& directory)
+{
+}
+
+bool FileWatcher::isValid()
+{
+    return false;
+}
+
+bool FileWatcher::waitForChanges(std::vector<std::filesystem::path>& changed, std::chrono::milliseconds debounce)
+{
+    return false;
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef SHADERFAX_FILEWATCHER_H
+#define SHADERFAX_FILEWATCHER_H
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <vector>
+
+///Reports files created, modified, moved or deleted anywhere under a folder. Only implemented with inotify on Linux
+class FileWatcher
+{
+private:
+  int _descriptor = -1;
+  std::map<int,std::filesystem::path> _watches;
+  std::vector<std::filesystem::path> _ignored;
+  void addDirectory(const std::filesystem::path& directory);
+public:
+  FileWatcher(const std::filesystem::path& root);
+  ~FileWatcher();
+  FileWatcher(const FileWatcher&) = delete;
+  FileWatcher& operator=(const FileWatcher&) = delete;
+  bool isValid();
+  ///Never reports changes to a file or anything under a folder, nor to the .tmp file a writer renames over it. For the
+  ///outputs of whatever reacts to the changes
+  void ignore(const std::filesystem::path& path);
+  bool isIgnored(const std::filesystem::path& path);
+  ///Blocks until something changes, then keeps collecting until nothing has changed for the debounce period. Returns false if watching failed
+  bool waitForChanges(std::vector<std::filesystem::path>& changed, std::chrono::milliseconds debounce);
+};
+
+#endif //SHADERFAX_FILEWATCHER_H
@@ -0,0 +1,181 @@
+#include "GatherWriter.h"
+
+#include <cstring>
+#include <fstream>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <fcntl.h>
+#include <limits.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+void GatherWriter::appendMetadata(const void* data, size_t size)
+{
+    if (_segments.empty() || _segments.back().data != nullptr)
+    {
+        _segments.push_back({.data = nullptr,.offset = _metadata.size(),.size = 0});
+    }
+    auto bytes = (const char*)data;
+    _metadata.insert(_metadata.end(),bytes,bytes+size);
+    _segments.back().size += size;
+    _size += size;
+}
+
+void GatherWriter::appendData(const void* data, size_t size)
+{
+    _segments.push_back({.data = (const char*)data,.offset = 0,.size = size});
+    _size += size;
+}
+
+void GatherWriter::reserveMetadata(size_t size)
+{
+    _metadata.reserve(size);
+}
+
+void GatherWriter::appendPadding(size_t alignment)
+{
+    static const char zeros[16] = {};
+    auto padding = alignUp(_size,alignment) - _size;
+    if (padding)
+    {
+        appendMetadata(zeros,padding);
+    }
+}
+
+const char* GatherWriter::segmentData(const Segment& segment)
+{
+    return segment.data ? segment.data : _metadata.data() + segment.offset;
+}
+
+size_t GatherWriter::size()
+{
+    return _size;
+}
+
+void GatherWriter::copyTo(std::vector<char>& bytes)
+{
+    bytes.clear();
+    bytes.reserve(_size);
+    for (auto& segment: _segments)
+    {
+        auto data = segmentData(segment);
+        bytes.insert(bytes.end(),data,data + segment.size);
+    }
+}
+
+bool GatherWriter::matches(const std::filesystem::path& file)
+{
+    std::error_code error;
+    if (std::filesystem::file_size(file,error) != _size || error)
+    {
+        return false;
+    }
+    std::ifstream inFile(file, std::ios::binary);
+    if (!inFile.is_open())
+    {
+        return false;
+    }
+    std::vector<char> existing;
+    for (auto& segment: _segments)
+    {
+        existing.resize(segment.size);
+        if (!inFile.read(existing.data(),segment.size) || std::memcmp(existing.data(),segmentData(segment),segment.size) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+WriteResult GatherWriter::write(const std::filesystem::path& file)
+{
+    if (matches(file))
+    {
+        return WriteResult::UNCHANGED;
+    }
+    auto temporary = file;
+    temporary += ".tmp";
+
+#ifndef _WIN32
+    int descriptor = open(temporary.c_str(),O_WRONLY|O_CREAT|O_TRUNC|O_CLOEXEC,0644);
+    if (descriptor < 0)
+    {
+        return WriteResult::FAILED;
+    }
+    std::vector<iovec> vectors;
+    vectors.reserve(_segments.size());
+    for (auto& segment: _segments)
+    {
+        if (segment.size)
+        {
+            vectors.push_back({.iov_base = (void*)segmentData(segment),.iov_len = segment.size});
+        }
+    }
+    size_t first = 0;
+    while (first < vectors.size())
+    {
+        int count = std::min<size_t>(vectors.size()-first,IOV_MAX);
+        auto written = writev(descriptor,&vectors[first],count);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            close(descriptor);
+            std::filesystem::remove(temporary);
+            return WriteResult::FAILED;
+        }
+        //skip fully written vectors and trim a partially written one
+        while (first < vectors.size() && written >= (ssize_t)vectors[first].iov_len)
+        {
+            written -= vectors[first].iov_len;
+            ++first;
+        }
+        if (written > 0)
+        {
+            vectors[first].iov_base = (char*)vectors[first].iov_base + written;
+            vectors[first].iov_len -= written;
+        }
+    }
+    if (close(descriptor) != 0)
+    {
+        std::filesystem::remove(temporary);
+        return WriteResult::FAILED;
+    }
+#else
+    {
+        std::ofstream outFile(temporary, std::ios::trunc|std::ios::binary);
+        if (!outFile.is_open())
+        {
+            return WriteResult::FAILED;
+        }
+        for (auto& segment: _segments)
+        {
+            outFile.write(segmentData(segment),segment.size);
+        }
+        outFile.close();
+        if (!outFile)
+        {
+            std::filesystem::remove(temporary);
+            return WriteResult::FAILED;
+        }
+    }
+#endif
+
+    std::error_code error;
+    std::filesystem::rename(temporary,file,error);
+    if (error)
+    {
+        std::filesystem::remove(temporary,error);
+        return WriteResult::FAILED;
+    }
+    return WriteResult::WRITTEN;
+}
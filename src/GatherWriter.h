@@ -0,0 +1,59 @@
+#ifndef SHADERFAX_GATHERWRITER_H
+#define SHADERFAX_GATHERWRITER_H
+#include <cstddef>
+#include <filesystem>
+#include <vector>
+
+#include <boost/endian/conversion.hpp>
+
+enum class WriteResult
+{
+  WRITTEN,
+  ///The file already held exactly these bytes and was left untouched
+  UNCHANGED,
+  FAILED
+};
+
+size_t alignUp(size_t value, size_t alignment);
+
+///Builds a file out of metadata it owns and byte ranges it borrows, and writes both with gathered writes so the borrowed
+///bytes are never copied. Borrowed ranges have to outlive the writer
+class GatherWriter
+{
+private:
+  struct Segment
+  {
+    const char* data = nullptr;
+    ///Offset into _metadata when data is null
+    size_t offset = 0;
+    size_t size = 0;
+  };
+  std::vector<char> _metadata;
+  std::vector<Segment> _segments;
+  size_t _size = 0;
+  const char* segmentData(const Segment& segment);
+protected:
+  ///Metadata offsets stay valid if this is too small, it only saves reallocations
+  void reserveMetadata(size_t size);
+  void appendMetadata(const void* data, size_t size);
+  template<typename T>
+  void appendValue(T value)
+  {
+    boost::endian::native_to_little_inplace(value);
+    appendMetadata(&value,sizeof(T));
+  }
+  ///Pads with zeros until the file size is a multiple of alignment
+  void appendPadding(size_t alignment);
+  void appendData(const void* data, size_t size);
+public:
+  ///Size of the whole file in bytes
+  size_t size();
+  ///Copies the whole file into memory, for sending it somewhere besides the disk
+  void copyTo(std::vector<char>& bytes);
+  ///Whether the file on disk already holds exactly these bytes
+  bool matches(const std::filesystem::path& file);
+  ///Writes to a temporary file and renames it over the destination, skipping the write if nothing changed
+  WriteResult write(const std::filesystem::path& file);
+};
+
+#endif //SHADERFAX_GATHERWRITER_H
@@ -0,0 +1,131 @@
+#ifndef SHADERFAX_HASH_H
+#define SHADERFAX_HASH_H
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#include <boost/endian/conversion.hpp>
+
+///XXH64 of a block of memory. Used for content hashes of sources, options and compiled code
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0)
+{
+  constexpr uint64_t PRIME1 = 11400714785074694791ULL;
+  constexpr uint64_t PRIME2 = 14029467366897019727ULL;
+  constexpr uint64_t PRIME3 = 1609587929392839161ULL;
+  constexpr uint64_t PRIME4 = 9650029242287828579ULL;
+  constexpr uint64_t PRIME5 = 2870177450012600261ULL;
+
+  auto rotl = [](uint64_t value, int bits){return (value << bits) | (value >> (64 - bits));};
+  auto read64 = [](const unsigned char* p){uint64_t v; std::memcpy(&v,p,sizeof(v)); return boost::endian::little_to_native(v);};
+  auto read32 = [](const unsigned char* p){uint32_t v; std::memcpy(&v,p,sizeof(v)); return boost::endian::little_to_native(v);};
+  auto round = [&](uint64_t accumulator, uint64_t input)
+  {
+    accumulator += input * PRIME2;
+    accumulator = rotl(accumulator,31);
+    return accumulator * PRIME1;
+  };
+  auto mergeRound = [&](uint64_t accumulator, uint64_t value)
+  {
+    accumulator ^= round(0,value);
+    return accumulator * PRIME1 + PRIME4;
+  };
+
+  auto p = static_cast<const unsigned char*>(data);
+  auto end = p + size;
+  uint64_t hash;
+
+  if (size >= 32)
+  {
+    uint64_t v1 = seed + PRIME1 + PRIME2;
+    uint64_t v2 = seed + PRIME2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - PRIME1;
+    auto limit = end - 32;
+    do
+    {
+      v1 = round(v1,read64(p)); p += 8;
+      v2 = round(v2,read64(p)); p += 8;
+      v3 = round(v3,read64(p)); p += 8;
+      v4 = round(v4,read64(p)); p += 8;
+    }
+    while (p <= limit);
+    hash = rotl(v1,1) + rotl(v2,7) + rotl(v3,12) + rotl(v4,18);
+    hash = mergeRound(hash,v1);
+    hash = mergeRound(hash,v2);
+    hash = mergeRound(hash,v3);
+    hash = mergeRound(hash,v4);
+  }
+  else
+  {
+    hash = seed + PRIME5;
+  }
+
+  hash += size;
+  while (p + 8 <= end)
+  {
+    hash ^= round(0,read64(p));
+    hash = rotl(hash,27) * PRIME1 + PRIME4;
+    p += 8;
+  }
+  if (p + 4 <= end)
+  {
+    hash ^= uint64_t(read32(p)) * PRIME1;
+    hash = rotl(hash,23) * PRIME2 + PRIME3;
+    p += 4;
+  }
+  while (p < end)
+  {
+    hash ^= (*p) * PRIME5;
+    hash = rotl(hash,11) * PRIME1;
+    ++p;
+  }
+
+  hash ^= hash >> 33;
+  hash *= PRIME2;
+  hash ^= hash >> 29;
+  hash *= PRIME3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+inline uint64_t hashString(std::string_view text, uint64_t seed = 0)
+{
+  return hashBytes(text.data(),text.size(),seed);
+}
+
+///Order dependent combination of two hashes
+inline uint64_t hashCombine(uint64_t hash, uint64_t value)
+{
+  value = boost::endian::native_to_little(value);
+  return hashBytes(&value,sizeof(value),hash);
+}
+
+///Hashes a file's contents, returns false if it can't be read
+inline bool hashFile(const std::filesystem::path& file, uint64_t& hash)
+{
+  std::ifstream inFile(file, std::ios::binary);
+  if (!inFile.is_open())
+  {
+    return false;
+  }
+  std::string contents((std::istreambuf_iterator<char>(inFile)),std::istreambuf_iterator<char>());
+  hash = hashString(contents);
+  return true;
+}
+
+inline std::string hashToHex(uint64_t hash)
+{
+  constexpr char digits[] = "0123456789abcdef";
+  std::string text(16,'0');
+  for (int i = 15; i >= 0; --i)
+  {
+    text[i] = digits[hash & 0xF];
+    hash >>= 4;
+  }
+  return text;
+}
+
+#endif //SHADERFAX_HASH_H
@@ -0,0 +1,36 @@
+#ifndef SHADERFAX_JSON_H
+#define SHADERFAX_JSON_H
+#include <cstdio>
+#include <ostream>
+#include <string_view>
+
+///Writes text as a quoted, escaped JSON string
+inline void writeJsonString(std::ostream& out, std::string_view text)
+{
+  out << '"';
+  for (char c: text)
+  {
+    switch (c)
+    {
+      case '"': out << "\\\""; break;
+      case '\\': out << "\\\\"; break;
+      case '\n': out << "\\n"; break;
+      case '\r': out << "\\r"; break;
+      case '\t': out << "\\t"; break;
+      default:
+        if ((unsigned char)c < 0x20)
+        {
+          char escaped[8];
+          std::snprintf(escaped,sizeof(escaped),"\\u%04x",(unsigned char)c);
+          out << escaped;
+        }
+        else
+        {
+          out << c;
+        }
+    }
+  }
+  out << '"';
+}
+
+#endif //SHADERFAX_JSON_H
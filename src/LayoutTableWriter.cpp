@@ -0,0 +1,185 @@
+#include "LayoutTableWriter.h"
+
+#include <algorithm>
+#include <boost/endian/conversion.hpp>
+
+#include "Hash.h"
+
+using namespace shaderfax;
+
+bool isBindingBefore(const LayoutBindingRecord& a, const LayoutBindingRecord& b);
+bool isSameBinding(const LayoutBindingRecord& a, const LayoutBindingRecord& b);
+
+std::vector<LayoutBindingRecord> LayoutTableWriter::bindings(DescriptorSet& descriptorSet, uint32_t stageFlags)
+{
+    std::vector<LayoutBindingRecord> bindings;
+    for (auto i=0; i<descriptorSet.descriptorCount(); ++i)
+    {
+        auto& descriptor = descriptorSet.at(i);
+        bindings.push_back({.binding = (uint32_t)descriptor.index,.type = (uint32_t)descriptor.type,.count = (uint32_t)descriptor.count,.stageFlags = stageFlags});
+    }
+    //stable so names written in the same order pair up with the bindings of files sharing layouts
+    std::stable_sort(bindings.begin(),bindings.end(),isBindingBefore);
+    return bindings;
+}
+
+uint64_t LayoutTableWriter::layoutId(const std::vector<LayoutBindingRecord>& bindings)
+{
+    //hashed in their little endian file layout, so every host computes the same ids
+    std::vector<uint32_t> fields;
+    for (auto& binding: bindings)
+    {
+        for (auto value: {binding.binding,binding.type,binding.count,binding.stageFlags})
+        {
+            fields.push_back(boost::endian::native_to_little(value));
+        }
+    }
+    return hashBytes(fields.data(),fields.size()*sizeof(uint32_t));
+}
+
+std::vector<uint32_t> LayoutTableWriter::descriptorSetStages(const ShaderFileData& fileData)
+{
+    std::vector<uint32_t> stages(fileData.descriptorSets.size(),0);
+    auto addStages = [&](uint32_t firstStage, uint32_t stageCount, uint32_t firstSet, uint32_t setCount)
+    {
+        uint32_t flags = 0;
+        for (auto i=firstStage; i<firstStage + stageCount; ++i)
+        {
+            flags |= fileData.shaderOutData[i].stageFlag;
+        }
+        for (auto i=firstSet; i<firstSet + setCount; ++i)
+        {
+            stages[i] |= flags;
+        }
+    };
+    if (fileData.variants.empty())
+    {
+        addStages(0,fileData.shaderOutData.size(),0,fileData.descriptorSets.size());
+    }
+    //variants with identical sets share them, which then are bound for the stages of all of those variants
+    for (auto& variant: fileData.variants)
+    {
+        addStages(variant.firstStage,variant.stageCount,variant.firstDescriptorSet,variant.descriptorSetCount);
+    }
+    return stages;
+}
+
+void LayoutTableWriter::addLayouts(ShaderFileData& fileData)
+{
+    auto setStages = descriptorSetStages(fileData);
+    for (auto i=0; i<fileData.descriptorSets.size(); ++i)
+    {
+        auto layout = bindings(fileData.descriptorSets[i],setStages[i]);
+        _known.emplace(layoutId(layout),std::move(layout));
+    }
+}
+
+void LayoutTableWriter::addLayouts(const LayoutTableView& table)
+{
+    for (auto i=0; i<table.size(); ++i)
+    {
+        auto layout = table.bindings(i);
+        _known.emplace(table.id(i),std::vector<LayoutBindingRecord>(layout.begin(),layout.end()));
+    }
+}
+
+bool LayoutTableWriter::addFile(const ShaderFileView& file, std::ostream& errors)
+{
+    for (auto i=0; i<file.descriptorSetCount(); ++i)
+    {
+        auto descriptorSet = file.descriptorSet(i);
+        if (descriptorSet.layoutId() == 0)
+        {
+            errors << "the file doesn't record descriptor set layouts, rebuild it with --format v2\n";
+            return false;
+        }
+        if (file.sharesLayouts())
+        {
+            auto known = _known.find(descriptorSet.layoutId());
+            if (known == _known.end() || known->second.size() != descriptorSet.size())
+            {
+                errors << "descriptor set "<<descriptorSet.set()<<" uses a layout that none of the build's layout tables holds\n";
+                return false;
+            }
+            _layouts.insert(*known);
+            ++_setCount;
+            continue;
+        }
+        std::vector<LayoutBindingRecord> bindings;
+        for (auto j=0; j<descriptorSet.size(); ++j)
+        {
+            auto descriptor = descriptorSet[j];
+            bindings.push_back({.binding = descriptor.binding,.type = descriptor.type,.count = descriptor.count,.stageFlags = descriptorSet.stageFlags()});
+        }
+        std::stable_sort(bindings.begin(),bindings.end(),isBindingBefore);
+        if (layoutId(bindings) != descriptorSet.layoutId())
+        {
+            errors << "descriptor set "<<descriptorSet.set()<<" doesn't match its layout id\n";
+            return false;
+        }
+        auto [existing,added] = _layouts.emplace(descriptorSet.layoutId(),bindings);
+        if (!added && !std::equal(bindings.begin(),bindings.end(),existing->second.begin(),existing->second.end(),isSameBinding))
+        {
+            errors << "descriptor set "<<descriptorSet.set()<<" has the layout id of a different layout\n";
+            return false;
+        }
+        ++_setCount;
+    }
+    return true;
+}
+
+void LayoutTableWriter::finish()
+{
+    size_t bindingCount = 0;
+    for (auto& [id,bindings]: _layouts)
+    {
+        bindingCount += bindings.size();
+    }
+    size_t fileSize = sizeof(LayoutTableHeader) + _layouts.size()*sizeof(LayoutRecord) + bindingCount*sizeof(LayoutBindingRecord);
+    reserveMetadata(fileSize);
+
+    appendMetadata(LAYOUT_TABLE_MAGIC,sizeof(LAYOUT_TABLE_MAGIC));
+    appendValue<uint32_t>(LAYOUT_TABLE_VERSION);
+    appendValue<uint32_t>(sizeof(LayoutTableHeader));
+    appendValue<uint64_t>(fileSize);
+    appendValue<uint32_t>(_layouts.size());
+    appendValue<uint32_t>(bindingCount);
+    uint32_t firstBinding = 0;
+    for (auto& [id,bindings]: _layouts)
+    {
+        appendValue<uint64_t>(id);
+        appendValue<uint32_t>(firstBinding);
+        appendValue<uint32_t>(bindings.size());
+        firstBinding += bindings.size();
+    }
+    for (auto& [id,bindings]: _layouts)
+    {
+        for (auto& binding: bindings)
+        {
+            appendValue<uint32_t>(binding.binding);
+            appendValue<uint32_t>(binding.type);
+            appendValue<uint32_t>(binding.count);
+            appendValue<uint32_t>(binding.stageFlags);
+        }
+    }
+}
+
+size_t LayoutTableWriter::layoutCount()
+{
+    return _layouts.size();
+}
+
+size_t LayoutTableWriter::setCount()
+{
+    return _setCount;
+}
+
+bool isBindingBefore(const LayoutBindingRecord& a, const LayoutBindingRecord& b)
+{
+    return a.binding < b.binding;
+}
+
+bool isSameBinding(const LayoutBindingRecord& a, const LayoutBindingRecord& b)
+{
+    return a.binding == b.binding && a.type == b.type && a.count == b.count && a.stageFlags == b.stageFlags;
+}
@@ -0,0 +1,46 @@
+#ifndef SHADERFAX_LAYOUTTABLEWRITER_H
+#define SHADERFAX_LAYOUTTABLEWRITER_H
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <vector>
+
+#include <shaderfax/LayoutFormat.h>
+#include <shaderfax/Reader.h>
+
+#include "GatherWriter.h"
+#include "ShaderFileData.h"
+
+///Serializes a descriptor layout table, see shaderfax/LayoutFormat.h. Layouts are collected from the v2 files of a build,
+///which record the id of every descriptor set's layout, so files skipped by incremental builds and files of other shards
+///contribute the same way freshly compiled ones do. Files sharing layouts only name their descriptors, their layouts have to
+///be made known from the compiled data or an earlier table before the files are added
+class LayoutTableWriter : public GatherWriter
+{
+private:
+  std::map<uint64_t,std::vector<shaderfax::LayoutBindingRecord>> _layouts;
+  ///Layouts files sharing layouts may use, only those added files use end up in the table
+  std::map<uint64_t,std::vector<shaderfax::LayoutBindingRecord>> _known;
+  size_t _setCount = 0;
+public:
+  ///Bindings of a descriptor set sorted by binding, every one bound for stageFlags
+  static std::vector<shaderfax::LayoutBindingRecord> bindings(DescriptorSet& descriptorSet, uint32_t stageFlags);
+  static uint64_t layoutId(const std::vector<shaderfax::LayoutBindingRecord>& bindings);
+  ///StageFlags of every descriptor set of a file, the stages of every variant using the set
+  static std::vector<uint32_t> descriptorSetStages(const ShaderFileData& fileData);
+
+  ///Makes the layout of every descriptor set of a compiled file known
+  void addLayouts(ShaderFileData& fileData);
+  ///Makes every layout of a table known
+  void addLayouts(const shaderfax::LayoutTableView& table);
+  ///Adds the layout of every descriptor set of a file, fails for files that don't record layouts or whose layout doesn't
+  ///match its id, and for files sharing a layout that isn't known
+  bool addFile(const shaderfax::ShaderFileView& file, std::ostream& errors);
+  ///Lays out the table, call once after every file was added
+  void finish();
+  size_t layoutCount();
+  ///Descriptor sets of every added file, each using one of the layouts
+  size_t setCount();
+};
+
+#endif //SHADERFAX_LAYOUTTABLEWRITER_H
@@ -0,0 +1,55 @@
+#ifndef SHADERFAX_MEMORYBLOB_H
+#define SHADERFAX_MEMORYBLOB_H
+#include <atomic>
+#include <vector>
+
+#include <slang.h>
+#include <slang-com-ptr.h>
+
+///Reference counted blob over bytes that didn't come from Slang, so they can be stored anywhere compiled code is
+class MemoryBlob final : public ISlangBlob
+{
+private:
+  std::atomic<uint32_t> _referenceCount = 0;
+  std::vector<char> _data;
+  MemoryBlob(std::vector<char> data): _data(std::move(data)){}
+public:
+  static Slang::ComPtr<ISlangBlob> create(std::vector<char> data)
+  {
+    return Slang::ComPtr<ISlangBlob>(new MemoryBlob(std::move(data)));
+  }
+  SLANG_NO_THROW SlangResult SLANG_MCALL queryInterface(SlangUUID const& uuid, void** outObject) override
+  {
+    if (uuid == ISlangBlob::getTypeGuid() || uuid == ISlangUnknown::getTypeGuid())
+    {
+      addRef();
+      *outObject = static_cast<ISlangBlob*>(this);
+      return SLANG_OK;
+    }
+    *outObject = nullptr;
+    return SLANG_E_NO_INTERFACE;
+  }
+  SLANG_NO_THROW uint32_t SLANG_MCALL addRef() override
+  {
+    return ++_referenceCount;
+  }
+  SLANG_NO_THROW uint32_t SLANG_MCALL release() override
+  {
+    auto count = --_referenceCount;
+    if (count == 0)
+    {
+      delete this;
+    }
+    return count;
+  }
+  SLANG_NO_THROW void const* SLANG_MCALL getBufferPointer() override
+  {
+    return _data.data();
+  }
+  SLANG_NO_THROW size_t SLANG_MCALL getBufferSize() override
+  {
+    return _data.size();
+  }
+};
+
+#endif //SHADERFAX_MEMORYBLOB_H
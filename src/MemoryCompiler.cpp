@@ -0,0 +1,84 @@
+#include "MemoryCompiler.h"
+
+#include <set>
+#include <sstream>
+
+#include "VariantMatrix.h"
+
+MemoryCompiler::MemoryCompiler(const CompileSettings& settings, Slang::ComPtr<MemoryFileSystem> fileSystem)
+    : _fileSystem(std::move(fileSystem)),_compiler(".",settings,_fileSystem)
+{
+    _generation = _fileSystem->generation();
+}
+
+MemoryFileSystem& MemoryCompiler::sources()
+{
+    return *_fileSystem;
+}
+
+bool MemoryCompiler::compile(const std::string& path, ShaderFileData& fileData, std::ostream& errors, std::vector<std::string>* dependencies)
+{
+    fileData = {};
+    std::string source;
+    if (!_fileSystem->getSource(path,source))
+    {
+        errors << "No source for "<<path<<"\n";
+        return false;
+    }
+    std::istringstream sourceStream(source);
+    VariantMatrix matrix;
+    if (!matrix.read(sourceStream,path,errors))
+    {
+        return false;
+    }
+    //the session keeps every module it loaded, which is only right while none of the sources changed
+    auto generation = _fileSystem->generation();
+    if (generation != _generation)
+    {
+        _compiler.resetSession();
+        _generation = generation;
+    }
+
+    std::vector<ShaderFileData> outputs(matrix.combinationCount());
+    std::vector<ShaderMacro> macros;
+    std::set<std::string> files;
+    bool hasEntryPoints = true;
+    for (auto i=0; i<outputs.size() && hasEntryPoints; ++i)
+    {
+        matrix.macros(i,macros);
+        _compiler.setMacros(macros);
+        slang::IModule* module = nullptr;
+        if (!_compiler.loadModule(path,module,errors))
+        {
+            return false;
+        }
+        if (!module)
+        {
+            hasEntryPoints = false;
+            break;
+        }
+        for (auto j=0; j<module->getDependencyFileCount(); ++j)
+        {
+            files.insert(MemoryFileSystem::key(module->getDependencyFilePath(j)));
+        }
+        hasEntryPoints = module->getDefinedEntryPointCount() > 0;
+        if (hasEntryPoints && !_compiler.compileModule(module,outputs[i],errors))
+        {
+            return false;
+        }
+    }
+
+    if (hasEntryPoints && matrix.empty())
+    {
+        fileData = std::move(outputs[0]);
+    }
+    else if (hasEntryPoints)
+    {
+        matrix.merge(outputs,fileData);
+    }
+    if (dependencies)
+    {
+        dependencies->assign(files.begin(),files.end());
+    }
+    return true;
+}
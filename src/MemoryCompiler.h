@@ -0,0 +1,33 @@
+#ifndef SHADERFAX_MEMORYCOMPILER_H
+#define SHADERFAX_MEMORYCOMPILER_H
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <slang-com-ptr.h>
+
+#include "MemoryFileSystem.h"
+#include "ShaderCompiler.h"
+#include "ShaderFileData.h"
+
+///Compiles modules whose sources are held in memory into file data in memory, so tools like editors rebuild shaders without
+///running Shaderfax or going through the disk. Like ShaderCompiler every thread needs its own, but they may share sources
+class MemoryCompiler
+{
+private:
+  Slang::ComPtr<MemoryFileSystem> _fileSystem;
+  ShaderCompiler _compiler;
+  ///Generation of the sources the loaded modules were read from
+  uint64_t _generation = 0;
+public:
+  MemoryCompiler(const CompileSettings& settings = {}, Slang::ComPtr<MemoryFileSystem> fileSystem = MemoryFileSystem::create());
+  ///Sources of every module and of the files they import, by path relative to the root with forward slashes
+  MemoryFileSystem& sources();
+  ///Compiles a module and every combination of its variant matrix. Modules loaded by earlier calls are reused until a
+  ///source changes. Modules without entry points are libraries and leave fileData without stages. dependencies receives
+  ///the paths of every source the module was built from
+  bool compile(const std::string& path, ShaderFileData& fileData, std::ostream& errors, std::vector<std::string>* dependencies = nullptr);
+};
+
+#endif //SHADERFAX_MEMORYCOMPILER_H
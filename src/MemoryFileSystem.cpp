@@ -0,0 +1,60 @@
+#include "MemoryFileSystem.h"
+
+#include <filesystem>
+#include <vector>
+
+#include "MemoryBlob.h"
+
+void MemoryFileSystem::setSource(const std::string& path, std::string source)
+{
+    std::lock_guard lock(_mutex);
+    _sources[key(path)] = std::move(source);
+    ++_generation;
+}
+
+void MemoryFileSystem::removeSource(const std::string& path)
+{
+    std::lock_guard lock(_mutex);
+    _sources.erase(key(path));
+    ++_generation;
+}
+
+bool MemoryFileSystem::getSource(const std::string& path, std::string& source)
+{
+    std::lock_guard lock(_mutex);
+    auto found = _sources.find(key(path));
+    if (found == _sources.end())
+    {
+        return false;
+    }
+    source = found->second;
+    return true;
+}
+
+std::string MemoryFileSystem::key(const std::string& path)
+{
+    //Slang joins search paths and the folders of importing files with the names it looks for, so ./a/../b.slang is b.slang
+    auto normal = std::filesystem::path(path).lexically_normal().generic_string();
+    if (normal.starts_with("./"))
+    {
+        normal.erase(0,2);
+    }
+    return normal;
+}
+
+SlangResult MemoryFileSystem::loadFile(char const* path, ISlangBlob** outBlob)
+{
+    *outBlob = nullptr;
+    std::vector<char> data;
+    {
+        std::lock_guard lock(_mutex);
+        auto source = _sources.find(key(path));
+        if (source == _sources.end())
+        {
+            return SLANG_E_NOT_FOUND;
+        }
+        data.assign(source->second.begin(),source->second.end());
+    }
+    *outBlob = MemoryBlob::create(std::move(data)).detach();
+    return SLANG_OK;
+}
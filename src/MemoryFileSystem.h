@@ -0,0 +1,73 @@
+#ifndef SHADERFAX_MEMORYFILESYSTEM_H
+#define SHADERFAX_MEMORYFILESYSTEM_H
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include <slang.h>
+#include <slang-com-ptr.h>
+
+///Sources Slang reads instead of files, keyed by their path relative to the search path with forward slashes. Sessions of
+///several compilers may share it, and sources may be replaced between builds
+class MemoryFileSystem final : public ISlangFileSystem
+{
+private:
+  std::atomic<uint32_t> _referenceCount = 0;
+  std::mutex _mutex;
+  std::map<std::string,std::string> _sources;
+  std::atomic<uint64_t> _generation = 0;
+  MemoryFileSystem() = default;
+public:
+  static Slang::ComPtr<MemoryFileSystem> create()
+  {
+    return Slang::ComPtr<MemoryFileSystem>(new MemoryFileSystem());
+  }
+  ///Adds or replaces the source of a file
+  void setSource(const std::string& path, std::string source);
+  void removeSource(const std::string& path);
+  ///Copies the source of a file, false if there is none
+  bool getSource(const std::string& path, std::string& source);
+  ///Changes whenever a source is set or removed, so compilers know when modules they loaded may be stale
+  uint64_t generation() const
+  {
+    return _generation;
+  }
+  ///Normalized form of a path Slang asks for, the key its source is stored under
+  static std::string key(const std::string& path);
+
+  SLANG_NO_THROW SlangResult SLANG_MCALL queryInterface(SlangUUID const& uuid, void** outObject) override
+  {
+    *outObject = castAs(uuid);
+    if (!*outObject)
+    {
+      return SLANG_E_NO_INTERFACE;
+    }
+    addRef();
+    return SLANG_OK;
+  }
+  SLANG_NO_THROW uint32_t SLANG_MCALL addRef() override
+  {
+    return ++_referenceCount;
+  }
+  SLANG_NO_THROW uint32_t SLANG_MCALL release() override
+  {
+    auto count = --_referenceCount;
+    if (count == 0)
+    {
+      delete this;
+    }
+    return count;
+  }
+  SLANG_NO_THROW void* SLANG_MCALL castAs(SlangUUID const& guid) override
+  {
+    if (guid == ISlangFileSystem::getTypeGuid() || guid == ISlangCastable::getTypeGuid() || guid == ISlangUnknown::getTypeGuid())
+    {
+      return static_cast<ISlangFileSystem*>(this);
+    }
+    return nullptr;
+  }
+  SLANG_NO_THROW SlangResult SLANG_MCALL loadFile(char const* path, ISlangBlob** outBlob) override;
+};
+
+#endif //SHADERFAX_MEMORYFILESYSTEM_H
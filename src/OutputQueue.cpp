@@ -0,0 +1,68 @@
+#include "OutputQueue.h"
+
+OutputQueue::OutputQueue(size_t budget)
+{
+    _budget = budget;
+}
+
+void OutputQueue::push(PendingOutput output)
+{
+    std::unique_lock lock(_mutex);
+    _changed.wait(lock,[&](){return _abandoned || _inFlight == 0 || _inFlight + output.size <= _budget;});
+    if (_abandoned)
+    {
+        return;
+    }
+    _inFlight += output.size;
+    _outputs.push_back(std::move(output));
+    _changed.notify_all();
+}
+
+bool OutputQueue::pop(PendingOutput& output)
+{
+    std::unique_lock lock(_mutex);
+    _changed.wait(lock,[&](){return _closed || !_outputs.empty();});
+    if (_outputs.empty())
+    {
+        return false;
+    }
+    output = std::move(_outputs.front());
+    _outputs.pop_front();
+    return true;
+}
+
+void OutputQueue::release(size_t size)
+{
+    std::lock_guard lock(_mutex);
+    _inFlight -= size;
+    _changed.notify_all();
+}
+
+void OutputQueue::close()
+{
+    std::lock_guard lock(_mutex);
+    _closed = true;
+    _changed.notify_all();
+}
+
+void OutputQueue::abandon()
+{
+    std::lock_guard lock(_mutex);
+    _abandoned = true;
+    _outputs.clear();
+    _changed.notify_all();
+}
+
+size_t codeSize(const ShaderFileData& fileData)
+{
+    size_t size = 0;
+    for (auto& outData: fileData.shaderOutData)
+    {
+        size += outData.spirvCode ? outData.spirvCode->getBufferSize() : 0;
+        for (auto& targetCode: outData.targetCode)
+        {
+            size += targetCode.code ? targetCode.code->getBufferSize() : 0;
+        }
+    }
+    return size;
+}
@@ -0,0 +1,50 @@
+#ifndef SHADERFAX_OUTPUTQUEUE_H
+#define SHADERFAX_OUTPUTQUEUE_H
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+
+#include "ShaderFileData.h"
+
+///Compiled module on its way from a compile worker to the writer thread
+struct PendingOutput
+{
+  ///Path of the .cshdr file relative to the output folder
+  std::filesystem::path relativePath;
+  ShaderFileData fileData;
+  ///Bytes of code the file data holds, counted against the queue budget until the writer releases it
+  size_t size = 0;
+};
+
+///Hands compiled modules to the writer as soon as they are finished. Producers block while the code in flight exceeds the
+///budget, so memory stays bounded however many modules a build has and writing overlaps compilation
+class OutputQueue
+{
+private:
+  size_t _budget;
+  size_t _inFlight = 0;
+  bool _closed = false;
+  bool _abandoned = false;
+  std::deque<PendingOutput> _outputs;
+  std::mutex _mutex;
+  std::condition_variable _changed;
+public:
+  explicit OutputQueue(size_t budget);
+  ///Blocks until the output fits in the budget. An output larger than the whole budget waits until nothing else is in flight
+  void push(PendingOutput output);
+  ///Blocks until an output is available, returns false once the queue is closed and drained
+  bool pop(PendingOutput& output);
+  ///Returns the budget taken by a popped output, once the writer has written and dropped it
+  void release(size_t size);
+  ///Called once every producer is done
+  void close();
+  ///Called by a writer that stopped, producers no longer wait and their outputs are dropped
+  void abandon();
+};
+
+///Bytes of code of every stage and target in a file
+size_t codeSize(const ShaderFileData& fileData);
+
+#endif //SHADERFAX_OUTPUTQUEUE_H
@@ -0,0 +1,127 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <map>
+
+#include "Json.h"
+
+///Trace tracks are numbered in the order threads first record something
+uint32_t threadIndex();
+
+void Profiler::record(const char* phase, std::string name, std::string path, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    Event event{.phase = phase,.name = std::move(name),.path = std::move(path),.thread = threadIndex(),.start = start - _origin,.duration = end - start};
+    std::lock_guard lock(_mutex);
+    _events.push_back(std::move(event));
+}
+
+bool Profiler::writeTrace(const std::filesystem::path& file)
+{
+    std::lock_guard lock(_mutex);
+    std::ofstream out(file, std::ios::trunc);
+    if (!out.is_open())
+    {
+        return false;
+    }
+    auto microseconds = [](std::chrono::nanoseconds time){return std::chrono::duration<double,std::micro>(time).count();};
+    uint32_t threadCount = 0;
+    out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+    for (auto& event: _events)
+    {
+        out << "{\"name\":";
+        writeJsonString(out,event.name);
+        out << ",\"cat\":\"" << event.phase << "\",\"ph\":\"X\",\"ts\":" << microseconds(event.start) << ",\"dur\":" << microseconds(event.duration)
+            << ",\"pid\":1,\"tid\":" << event.thread << ",\"args\":{\"phase\":\"" << event.phase << "\"";
+        if (!event.path.empty())
+        {
+            out << ",\"path\":";
+            writeJsonString(out,event.path);
+        }
+        out << "}},\n";
+        threadCount = std::max(threadCount,event.thread + 1);
+    }
+    for (uint32_t i=0; i<threadCount; ++i)
+    {
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"name\":\"" << (i == 0 ? "main" : "thread " + std::to_string(i)) << "\"}}"
+            << (i + 1 < threadCount ? ",\n" : "\n");
+    }
+    out << "]}\n";
+    out.close();
+    return (bool)out;
+}
+
+void Profiler::printSummary(std::ostream& out, size_t moduleCount)
+{
+    std::lock_guard lock(_mutex);
+    std::map<std::string,std::pair<std::chrono::nanoseconds,size_t>> phases;
+    std::vector<const Event*> modules;
+    for (auto& event: _events)
+    {
+        auto& phase = phases[event.phase];
+        phase.first += event.duration;
+        ++phase.second;
+        if (std::string_view(event.phase) == "module")
+        {
+            modules.push_back(&event);
+        }
+    }
+    auto milliseconds = [](std::chrono::nanoseconds time){return std::chrono::duration<double,std::milli>(time).count();};
+    auto flags = out.flags();
+    out << std::fixed << std::setprecision(1);
+
+    std::vector<std::pair<std::string,std::pair<std::chrono::nanoseconds,size_t>>> sortedPhases(phases.begin(),phases.end());
+    std::sort(sortedPhases.begin(),sortedPhases.end(),[](const auto& a, const auto& b){return a.second.first > b.second.first;});
+    out << "Time per phase, summed over every thread:\n";
+    for (auto& [name,phase]: sortedPhases)
+    {
+        out << "  " << std::left << std::setw(10) << name << std::right << std::setw(12) << milliseconds(phase.first) << " ms" << std::setw(8) << phase.second << " times\n";
+    }
+
+    moduleCount = std::min(moduleCount,modules.size());
+    std::partial_sort(modules.begin(),modules.begin() + moduleCount,modules.end(),[](const Event* a, const Event* b){return a->duration > b->duration;});
+    if (moduleCount > 0)
+    {
+        out << "Slowest modules:\n";
+    }
+    for (size_t i=0; i<moduleCount; ++i)
+    {
+        out << std::setw(12) << milliseconds(modules[i]->duration) << " ms  " << modules[i]->name << "\n";
+    }
+    out.flags(flags);
+}
+
+ProfileScope::ProfileScope(Profiler* profiler, const char* phase, std::string_view name, std::string_view path)
+{
+    _profiler = profiler;
+    _phase = phase;
+    if (_profiler)
+    {
+        _name = name;
+        _path = path;
+        _start = std::chrono::steady_clock::now();
+    }
+}
+
+ProfileScope::~ProfileScope()
+{
+    stop();
+}
+
+void ProfileScope::stop()
+{
+    if (_profiler)
+    {
+        _profiler->record(_phase,std::move(_name),std::move(_path),_start,std::chrono::steady_clock::now());
+        _profiler = nullptr;
+    }
+}
+
+uint32_t threadIndex()
+{
+    static std::atomic<uint32_t> threadCount = 0;
+    thread_local uint32_t index = threadCount++;
+    return index;
+}
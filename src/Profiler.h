@@ -0,0 +1,54 @@
+#ifndef SHADERFAX_PROFILER_H
+#define SHADERFAX_PROFILER_H
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+///Collects timed phases from every thread, for a Chrome/Perfetto trace and a summary of where a build spent its time
+class Profiler
+{
+private:
+  struct Event
+  {
+    const char* phase;
+    std::string name;
+    std::string path;
+    uint32_t thread;
+    std::chrono::nanoseconds start;
+    std::chrono::nanoseconds duration;
+  };
+  std::chrono::steady_clock::time_point _origin = std::chrono::steady_clock::now();
+  std::mutex _mutex;
+  std::vector<Event> _events;
+public:
+  ///Records a finished phase. The name labels the event, usually a module or entry point, and path is the source file it
+  ///belongs to
+  void record(const char* phase, std::string name, std::string path, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+  ///Writes every event in the Chrome trace event format, one track per thread
+  bool writeTrace(const std::filesystem::path& file);
+  ///Prints the total time of every phase and the slowest modules
+  void printSummary(std::ostream& out, size_t moduleCount);
+};
+
+///Records the time until it is stopped or destroyed as one phase, does nothing without a profiler
+class ProfileScope
+{
+private:
+  Profiler* _profiler;
+  const char* _phase;
+  std::string _name;
+  std::string _path;
+  std::chrono::steady_clock::time_point _start;
+public:
+  ProfileScope(Profiler* profiler, const char* phase, std::string_view name, std::string_view path = {});
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+  ~ProfileScope();
+  void stop();
+};
+
+#endif //SHADERFAX_PROFILER_H
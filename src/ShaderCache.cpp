@@ -0,0 +1,465 @@
+#include "ShaderCache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+#include <boost/endian/conversion.hpp>
+#include <boost/interprocess/sync/file_lock.hpp>
+
+#include "Hash.h"
+#include "MemoryBlob.h"
+
+constexpr char CACHE_MAGIC[8] = {'s','f','x','c','a','c','h','e'};
+constexpr uint32_t CACHE_VERSION = 5;
+constexpr const char* CACHE_EXTENSION = ".sfxc";
+///Eviction trims the cache below its limit by this fraction so it doesn't run again on the very next store
+constexpr double EVICTION_TARGET = 0.9;
+
+template<typename T>
+static void appendValue(std::vector<char>& data, T value)
+{
+    boost::endian::native_to_little_inplace(value);
+    auto bytes = (char*)&value;
+    data.insert(data.end(),bytes,bytes+sizeof(T));
+}
+static void appendString(std::vector<char>& data, const std::string& text)
+{
+    appendValue<uint32_t>(data,text.size());
+    data.insert(data.end(),text.begin(),text.end());
+}
+
+///Bounds checked reader over a cache entry
+struct CacheReader
+{
+    const char* position;
+    const char* end;
+    template<typename T>
+    bool read(T& value)
+    {
+        if (end - position < sizeof(T))
+        {
+            return false;
+        }
+        std::memcpy(&value,position,sizeof(T));
+        boost::endian::little_to_native_inplace(value);
+        position += sizeof(T);
+        return true;
+    }
+    bool read(std::string& text)
+    {
+        uint32_t size = 0;
+        if (!read(size) || end - position < size)
+        {
+            return false;
+        }
+        text.assign(position,size);
+        position += size;
+        return true;
+    }
+};
+
+ShaderCache::ShaderCache(const std::filesystem::path& directory, uint64_t maxSize)
+{
+    _directory = directory;
+    _maxSize = maxSize;
+    std::error_code error;
+    std::filesystem::create_directories(_directory,error);
+}
+
+const std::filesystem::path& ShaderCache::directory()
+{
+    return _directory;
+}
+
+std::filesystem::path ShaderCache::entryPath(uint64_t key)
+{
+    auto name = hashToHex(key);
+    return _directory/name.substr(0,2)/(name+CACHE_EXTENSION);
+}
+
+bool ShaderCache::readEntry(uint64_t key, std::vector<char>& data, size_t& payload)
+{
+    auto file = entryPath(key);
+    std::ifstream inFile(file, std::ios::binary);
+    if (!inFile.is_open())
+    {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(inFile),std::istreambuf_iterator<char>());
+    inFile.close();
+
+    CacheReader reader{.position = data.data(),.end = data.data()+data.size()};
+    if (data.size() < sizeof(CACHE_MAGIC) || std::memcmp(data.data(),CACHE_MAGIC,sizeof(CACHE_MAGIC)) != 0)
+    {
+        return false;
+    }
+    reader.position += sizeof(CACHE_MAGIC);
+    uint32_t version = 0;
+    uint64_t storedKey = 0;
+    uint64_t payloadHash = 0;
+    if (!reader.read(version) || version != CACHE_VERSION || !reader.read(storedKey) || storedKey != key || !reader.read(payloadHash))
+    {
+        return false;
+    }
+    std::error_code error;
+    if (hashBytes(reader.position,reader.end-reader.position) != payloadHash)
+    {
+        //torn or corrupt entry, drop it so the next store replaces it
+        std::filesystem::remove(file,error);
+        return false;
+    }
+    payload = reader.position - data.data();
+
+    //mark the entry as recently used for eviction
+    std::filesystem::last_write_time(file,std::filesystem::file_time_type::clock::now(),error);
+    return true;
+}
+
+void ShaderCache::writeEntry(uint64_t key, const std::vector<char>& payload)
+{
+    std::vector<char> header(CACHE_MAGIC,CACHE_MAGIC+sizeof(CACHE_MAGIC));
+    appendValue<uint32_t>(header,CACHE_VERSION);
+    appendValue<uint64_t>(header,key);
+    appendValue<uint64_t>(header,hashBytes(payload.data(),payload.size()));
+
+    auto file = entryPath(key);
+    std::error_code error;
+    std::filesystem::create_directories(file.parent_path(),error);
+
+    thread_local std::mt19937_64 random(std::random_device{}());
+    auto temporary = file;
+    temporary += "." + hashToHex(random()) + ".tmp";
+    {
+        std::ofstream outFile(temporary, std::ios::trunc|std::ios::binary);
+        if (!outFile.is_open())
+        {
+            return;
+        }
+        outFile.write(header.data(),header.size());
+        outFile.write(payload.data(),payload.size());
+        outFile.close();
+        if (!outFile)
+        {
+            std::filesystem::remove(temporary,error);
+            return;
+        }
+    }
+    std::filesystem::rename(temporary,file,error);
+    if (error)
+    {
+        //another process published the same entry first
+        std::filesystem::remove(temporary,error);
+    }
+}
+
+bool ShaderCache::load(uint64_t key, ShaderOutData& outData, std::vector<DescriptorSet>& descriptorSets)
+{
+    std::vector<char> data;
+    size_t payload = 0;
+    if (!readEntry(key,data,payload))
+    {
+        return false;
+    }
+    CacheReader reader{.position = data.data() + payload,.end = data.data()+data.size()};
+
+    ShaderOutData cached{};
+    uint32_t parameterCount = 0;
+    if (!reader.read(cached.stage) || !reader.read(cached.entryPoint) || !reader.read(parameterCount))
+    {
+        return false;
+    }
+    for (auto i=0; i<parameterCount; ++i)
+    {
+        std::string parameter;
+        if (!reader.read(parameter))
+        {
+            return false;
+        }
+        cached.parameters.push_back(std::move(parameter));
+    }
+
+    std::vector<DescriptorSet> cachedSets;
+    uint32_t setCount = 0;
+    if (!reader.read(setCount))
+    {
+        return false;
+    }
+    for (auto i=0; i<setCount; ++i)
+    {
+        uint64_t setIndex = 0;
+        uint32_t descriptorCount = 0;
+        if (!reader.read(setIndex) || !reader.read(descriptorCount))
+        {
+            return false;
+        }
+        std::vector<Descriptor> descriptors;
+        for (auto j=0; j<descriptorCount; ++j)
+        {
+            Descriptor descriptor{};
+            uint32_t type = 0;
+            uint64_t index = 0;
+            uint64_t count = 0;
+            uint64_t size = 0;
+            uint32_t memberCount = 0;
+            if (!reader.read(descriptor.name) || !reader.read(type) || !reader.read(index) || !reader.read(count) || !reader.read(size) || !reader.read(memberCount))
+            {
+                return false;
+            }
+            descriptor.type = (DescriptorType)type;
+            descriptor.index = index;
+            descriptor.count = count;
+            descriptor.size = size;
+            for (auto k=0; k<memberCount; ++k)
+            {
+                UniformMember member;
+                if (!reader.read(member.name) || !reader.read(member.offset) || !reader.read(member.size) || !reader.read(member.type) || !reader.read(member.rows)
+                    || !reader.read(member.columns) || !reader.read(member.arrayCount) || !reader.read(member.arrayStride))
+                {
+                    return false;
+                }
+                descriptor.members.push_back(std::move(member));
+            }
+            descriptors.push_back(std::move(descriptor));
+        }
+        cachedSets.push_back(DescriptorSet(setIndex,std::move(descriptors)));
+    }
+
+    uint32_t targetCount = 0;
+    if (!reader.read(targetCount))
+    {
+        return false;
+    }
+    for (auto i=0; i<targetCount; ++i)
+    {
+        TargetCode targetCode{};
+        uint64_t size = 0;
+        if (!reader.read(targetCode.target) || !reader.read(size) || reader.end - reader.position < size)
+        {
+            return false;
+        }
+        targetCode.code = MemoryBlob::create(std::vector<char>(reader.position,reader.position + size));
+        reader.position += size;
+        cached.targetCode.push_back(std::move(targetCode));
+    }
+
+    uint64_t codeSize = 0;
+    if (!reader.read(codeSize) || reader.end - reader.position != codeSize)
+    {
+        return false;
+    }
+    cached.spirvCode = MemoryBlob::create(std::vector<char>(reader.position,reader.end));
+
+    outData = std::move(cached);
+    descriptorSets = std::move(cachedSets);
+    return true;
+}
+
+void ShaderCache::store(uint64_t key, const ShaderOutData& outData, std::vector<DescriptorSet>& descriptorSets)
+{
+    std::vector<char> payload;
+    appendString(payload,outData.stage);
+    appendString(payload,outData.entryPoint);
+    appendValue<uint32_t>(payload,outData.parameters.size());
+    for (auto& parameter: outData.parameters)
+    {
+        appendString(payload,parameter);
+    }
+    appendValue<uint32_t>(payload,descriptorSets.size());
+    for (auto& descriptorSet: descriptorSets)
+    {
+        appendValue<uint64_t>(payload,descriptorSet.index());
+        appendValue<uint32_t>(payload,descriptorSet.descriptorCount());
+        for (auto i=0; i<descriptorSet.descriptorCount(); ++i)
+        {
+            auto& descriptor = descriptorSet.at(i);
+            appendString(payload,descriptor.name);
+            appendValue<uint32_t>(payload,descriptor.type);
+            appendValue<uint64_t>(payload,descriptor.index);
+            appendValue<uint64_t>(payload,descriptor.count);
+            appendValue<uint64_t>(payload,descriptor.size);
+            appendValue<uint32_t>(payload,descriptor.members.size());
+            for (auto& member: descriptor.members)
+            {
+                appendString(payload,member.name);
+                appendValue<uint32_t>(payload,member.offset);
+                appendValue<uint32_t>(payload,member.size);
+                appendValue<uint32_t>(payload,member.type);
+                appendValue<uint16_t>(payload,member.rows);
+                appendValue<uint16_t>(payload,member.columns);
+                appendValue<uint32_t>(payload,member.arrayCount);
+                appendValue<uint32_t>(payload,member.arrayStride);
+            }
+        }
+    }
+    appendValue<uint32_t>(payload,outData.targetCode.size());
+    for (auto& targetCode: outData.targetCode)
+    {
+        auto code = (const char*)targetCode.code->getBufferPointer();
+        appendValue<uint32_t>(payload,targetCode.target);
+        appendValue<uint64_t>(payload,targetCode.code->getBufferSize());
+        payload.insert(payload.end(),code,code + targetCode.code->getBufferSize());
+    }
+    auto codeSize = outData.spirvCode->getBufferSize();
+    appendValue<uint64_t>(payload,codeSize);
+    auto code = (const char*)outData.spirvCode->getBufferPointer();
+    payload.insert(payload.end(),code,code+codeSize);
+    writeEntry(key,payload);
+}
+
+bool ShaderCache::loadModule(uint64_t key, CachedModule& module)
+{
+    std::vector<char> data;
+    size_t payload = 0;
+    if (!readEntry(key,data,payload))
+    {
+        return false;
+    }
+    CacheReader reader{.position = data.data() + payload,.end = data.data()+data.size()};
+
+    CachedModule cached{};
+    uint32_t sourceCount = 0;
+    if (!reader.read(cached.name) || !reader.read(sourceCount))
+    {
+        return false;
+    }
+    for (auto i=0; i<sourceCount; ++i)
+    {
+        std::string path;
+        uint64_t storedHash = 0;
+        uint64_t currentHash = 0;
+        if (!reader.read(path) || !reader.read(storedHash))
+        {
+            return false;
+        }
+        //the IR is only as current as every file it was built from
+        if (!hashFile(path,currentHash) || currentHash != storedHash)
+        {
+            return false;
+        }
+        cached.sources.push_back({std::move(path),storedHash});
+    }
+    cached.ir = MemoryBlob::create(std::vector<char>(reader.position,reader.end));
+    module = std::move(cached);
+    return true;
+}
+
+void ShaderCache::storeModule(uint64_t key, const CachedModule& module)
+{
+    std::vector<char> payload;
+    appendString(payload,module.name);
+    appendValue<uint32_t>(payload,module.sources.size());
+    for (auto& [path,hash]: module.sources)
+    {
+        appendString(payload,path.string());
+        appendValue<uint64_t>(payload,hash);
+    }
+    auto ir = (const char*)module.ir->getBufferPointer();
+    payload.insert(payload.end(),ir,ir + module.ir->getBufferSize());
+    writeEntry(key,payload);
+}
+
+bool ShaderCache::loadImports(uint64_t key, std::vector<std::filesystem::path>& imports)
+{
+    std::vector<char> data;
+    size_t payload = 0;
+    if (!readEntry(key,data,payload))
+    {
+        return false;
+    }
+    CacheReader reader{.position = data.data() + payload,.end = data.data()+data.size()};
+    uint32_t importCount = 0;
+    if (!reader.read(importCount))
+    {
+        return false;
+    }
+    imports.clear();
+    for (auto i=0; i<importCount; ++i)
+    {
+        std::string path;
+        if (!reader.read(path))
+        {
+            return false;
+        }
+        imports.push_back(std::move(path));
+    }
+    return true;
+}
+
+void ShaderCache::storeImports(uint64_t key, const std::vector<std::filesystem::path>& imports)
+{
+    std::vector<char> payload;
+    appendValue<uint32_t>(payload,imports.size());
+    for (auto& path: imports)
+    {
+        appendString(payload,path.string());
+    }
+    writeEntry(key,payload);
+}
+
+void ShaderCache::evict()
+{
+    auto lockFile = _directory/"evict.lock";
+    {
+        std::ofstream touch(lockFile, std::ios::app);
+    }
+    boost::interprocess::file_lock lock;
+    try
+    {
+        lock = boost::interprocess::file_lock(lockFile.string().c_str());
+        if (!lock.try_lock())
+        {
+            //another process is already evicting
+            return;
+        }
+    }
+    catch (const boost::interprocess::interprocess_exception& e)
+    {
+        return;
+    }
+
+    struct CacheFile
+    {
+        std::filesystem::path path;
+        uintmax_t size;
+        std::filesystem::file_time_type lastUsed;
+    };
+    std::vector<CacheFile> files;
+    uintmax_t totalSize = 0;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(_directory,error))
+    {
+        if (!entry.is_regular_file(error) || entry.path().extension() != CACHE_EXTENSION)
+        {
+            continue;
+        }
+        CacheFile file{.path = entry.path(),.size = entry.file_size(error),.lastUsed = entry.last_write_time(error)};
+        if (error)
+        {
+            continue;
+        }
+        totalSize += file.size;
+        files.push_back(file);
+    }
+    if (totalSize <= _maxSize)
+    {
+        lock.unlock();
+        return;
+    }
+
+    std::sort(files.begin(),files.end(),[](const CacheFile& a, const CacheFile& b){return a.lastUsed < b.lastUsed;});
+    uintmax_t target = _maxSize * EVICTION_TARGET;
+    for (auto& file: files)
+    {
+        if (totalSize <= target)
+        {
+            break;
+        }
+        if (std::filesystem::remove(file.path,error))
+        {
+            totalSize -= file.size;
+        }
+    }
+    lock.unlock();
+}
@@ -0,0 +1,49 @@
+#ifndef SHADERFAX_SHADERCACHE_H
+#define SHADERFAX_SHADERCACHE_H
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ShaderFileData.h"
+
+///Imported module loaded from source and serialized to Slang IR, so later sessions load it without parsing and checking it
+struct CachedModule
+{
+  ///Name the module was imported by
+  std::string name;
+  ///Contents of a .slang-module file
+  Slang::ComPtr<ISlangBlob> ir;
+  ///Every file the module was built from, with the hash of its contents when it was serialized
+  std::vector<std::pair<std::filesystem::path,uint64_t>> sources;
+};
+
+///On disk, content addressed store of compiled entry points. Entries are written to a temporary file and renamed into place,
+///so any number of threads and Shaderfax processes can share one cache directory
+class ShaderCache
+{
+private:
+  std::filesystem::path _directory;
+  uint64_t _maxSize = 0;
+  std::filesystem::path entryPath(uint64_t key);
+  ///Reads an entry and checks its header, payload is the offset of the bytes stored after it
+  bool readEntry(uint64_t key, std::vector<char>& data, size_t& payload);
+  void writeEntry(uint64_t key, const std::vector<char>& payload);
+public:
+  ShaderCache(const std::filesystem::path& directory, uint64_t maxSize);
+  const std::filesystem::path& directory();
+  ///Reads a cached entry point. Missing, unreadable or corrupt entries are treated as misses
+  bool load(uint64_t key, ShaderOutData& outData, std::vector<DescriptorSet>& descriptorSets);
+  void store(uint64_t key, const ShaderOutData& outData, std::vector<DescriptorSet>& descriptorSets);
+  ///Reads the IR of an imported module. Entries built from a file whose contents changed since are treated as misses
+  bool loadModule(uint64_t key, CachedModule& module);
+  void storeModule(uint64_t key, const CachedModule& module);
+  ///Absolute paths of the modules a module imported when it was last loaded, every module after the ones it imports
+  bool loadImports(uint64_t key, std::vector<std::filesystem::path>& imports);
+  void storeImports(uint64_t key, const std::vector<std::filesystem::path>& imports);
+  ///Removes least recently used entries until the cache fits in its size limit
+  void evict();
+};
+
+#endif //SHADERFAX_SHADERCACHE_H
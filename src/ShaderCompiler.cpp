@@ -0,0 +1,1076 @@
+#include "ShaderCompiler.h"
+
+#include <algorithm>
+#include <iostream>
+#include <set>
+
+#include "Hash.h"
+#include "MemoryBlob.h"
+#include "Texel.h"
+using namespace slang;
+
+enum attributeFlags: uint16_t
+{
+    POSITION3D=0b0000000000000001,
+    POSITION2D=0b0000000000000010,
+    NORMAL=0b0000000000000100,
+    UVCOORDS=0b0000000000001000,
+    VERTEXCOLOR=0b0000000000010000,
+    BONEWIEGHTS=0b0000000000100000
+
+};
+enum ShaderType
+{
+    UNKNOWN=0,
+    GRAPHICS,
+    COMPUTE,
+    RAY
+};
+enum GeometryPipelineType
+{
+    NA,
+    VERTEX,
+    MESH
+};
+
+bool isSameShaderType(ShaderType& existingType, ShaderType comparisonType, GeometryPipelineType& existingPipeline, GeometryPipelineType comparisonPipeline, const std::filesystem::path& currentFile, std::ostream& errors);
+bool isValidColorTarget(const std::string& colorTarget);
+bool isValidDepthTarget(const std::string & depthTarget);
+
+std::vector<std::string> getVertexParameters(FunctionReflection* reflection);
+std::vector<std::string> getHullParameters(FunctionReflection* reflection);
+std::vector<std::string> getDomainParameters(FunctionReflection* reflection);
+std::vector<std::string> getGeometryParameters(FunctionReflection* reflection);
+bool getFragmentParameters(FunctionReflection* reflection, std::vector<std::string>& parameters, const std::filesystem::path& currentFile, std::ostream& errors);
+std::vector<std::string> getComputeParameters(FunctionReflection* reflection);
+std::vector<std::string> getRayGenerationParameters(FunctionReflection* reflection);
+std::vector<std::string> getIntersectionParameters(FunctionReflection* reflection);
+std::vector<std::string> getAnyHitParameters(FunctionReflection* reflection);
+std::vector<std::string> getClosestHitParameters(FunctionReflection* reflection);
+std::vector<std::string> getMissParameters(FunctionReflection* reflection);
+std::vector<std::string> getCallableParameters(FunctionReflection* reflection);
+std::vector<std::string> getMeshParameters(FunctionReflection* reflection);
+std::vector<std::string> getAmplificationParameters(FunctionReflection* reflection);
+
+///Every option that affects the compiled output, shared by session creation and optionsHash so the two can't drift apart
+void getSessionOptions(const CompileSettings& settings, std::vector<TargetDesc>& targets, SlangMatrixLayoutMode& matrixLayout, std::vector<CompilerOptionEntry>& compilerOptions);
+///Code of a linked program for one target, of a single entry point or with entryPointIndex -1 of the whole program
+bool getCode(IComponentType* program, SlangInt entryPointIndex, SlangInt targetIndex, Slang::ComPtr<IBlob>& code, std::ostream& errors);
+///Hash of the contents of every file the module was built from
+bool hashModuleSources(IModule* module, uint64_t& hash);
+///Push constant block of an entry point, its uniform parameters or else a [vk::push_constant] global of the module
+PushConstantRange getPushConstants(ShaderReflection* layout, EntryPointReflection* entryPoint, uint32_t stageFlag);
+bool isPushConstantBlock(TypeLayoutReflection* typeLayout);
+
+ShaderCompiler::ShaderCompiler(const std::filesystem::path& root, const CompileSettings& settings, ISlangFileSystem* fileSystem)
+{
+    _root = root;
+    _settings = settings;
+    _fileSystem = fileSystem;
+    //paths in a file system other than the disk's aren't relative to the working directory
+    _searchPath = fileSystem ? root.generic_string() : absolute(root).string();
+
+    SlangGlobalSessionDesc globalDesc{};
+    createGlobalSession(&globalDesc,_globalSession.writeRef());
+    createSession();
+    _optionsHash = optionsHash(_settings);
+}
+
+void ShaderCompiler::resetSession()
+{
+    _session = nullptr;
+    _cachedModules.clear();
+    _loadedModules.clear();
+    _loadedModuleCount = 0;
+    createSession();
+}
+
+void ShaderCompiler::setMacros(const std::vector<ShaderMacro>& macros)
+{
+    if (macros == _macros)
+    {
+        return;
+    }
+    _macros = macros;
+    _macrosHash = 0;
+    for (auto& macro: _macros)
+    {
+        _macrosHash = hashString(macro.value,hashString(macro.name,_macrosHash));
+    }
+    resetSession();
+}
+
+void ShaderCompiler::createSession()
+{
+    const char* rootPath = _searchPath.c_str();
+    std::vector<PreprocessorMacroDesc> macros;
+    for (auto& macro: _macros)
+    {
+        macros.push_back({.name = macro.name.c_str(),.value = macro.value.c_str()});
+    }
+    std::vector<TargetDesc> targets;
+    SlangMatrixLayoutMode matrixLayout;
+    std::vector<CompilerOptionEntry> compilerOptions;
+    getSessionOptions(_settings,targets,matrixLayout,compilerOptions);
+
+    SessionDesc sessionDesc{};
+    sessionDesc.targets = targets.data();
+    sessionDesc.targetCount = targets.size();
+    sessionDesc.flags = kSessionFlags_None;
+    sessionDesc.defaultMatrixLayoutMode = matrixLayout;
+    sessionDesc.searchPaths = &rootPath;
+    sessionDesc.searchPathCount = 1;
+    sessionDesc.preprocessorMacros = macros.data();
+    sessionDesc.preprocessorMacroCount = macros.size();
+    sessionDesc.fileSystem = _fileSystem;
+    sessionDesc.enableEffectAnnotations = false;
+    sessionDesc.compilerOptionEntries = compilerOptions.data();
+    sessionDesc.compilerOptionEntryCount = compilerOptions.size();
+
+    _globalSession->createSession(sessionDesc, _session.writeRef());
+}
+
+void ShaderCompiler::setCache(ShaderCache* cache)
+{
+    _cache = _fileSystem ? nullptr : cache;
+}
+
+void ShaderCompiler::setProfiler(Profiler* profiler)
+{
+    _profiler = profiler;
+}
+
+bool ShaderCompiler::loadModule(const std::filesystem::path& relativePath, IModule*& module, std::ostream& errors)
+{
+    return loadModule(relativePath,nullptr,module,errors);
+}
+
+bool ShaderCompiler::loadModuleFromSource(const std::filesystem::path& relativePath, const std::string& source, IModule*& module, std::ostream& errors)
+{
+    return loadModule(relativePath,&source,module,errors);
+}
+
+bool ShaderCompiler::loadModule(const std::filesystem::path& relativePath, const std::string* source, IModule*& module, std::ostream& errors)
+{
+    module = nullptr;
+    ProfileScope scope(_profiler,"load",relativePath.generic_string(),relativePath.generic_string());
+    if (_cache)
+    {
+        loadCachedImports(relativePath);
+    }
+    Slang::ComPtr<IBlob> diagnostics;
+    IModule* loaded = nullptr;
+    if (source)
+    {
+        //named after the source, so sending the same source again finds the module already loaded
+        auto name = "inline-" + hashToHex(hashString(*source,hashString(relativePath.generic_string())));
+        auto path = std::filesystem::path(_searchPath)/relativePath;
+        auto blob = MemoryBlob::create(std::vector<char>(source->begin(),source->end()));
+        loaded = _session->loadModuleFromSource(name.c_str(),path.string().c_str(),blob,diagnostics.writeRef());
+    }
+    else
+    {
+        loaded = _session->loadModule(relativePath.string().c_str(),diagnostics.writeRef());
+    }
+    if (loaded && loaded->getDefinedEntryPointCount() == 0)
+    {
+        module = loaded;
+    }
+    else if (loaded)
+    {
+        bool compute = false;
+        bool graphics = false;
+        for (auto i=0; i< loaded->getDefinedEntryPointCount(); i++)
+        {
+            Slang::ComPtr<IEntryPoint> entryPoint = nullptr;
+            loaded->getDefinedEntryPoint(i,entryPoint.writeRef());
+            auto reflection =entryPoint->getFunctionReflection();
+            auto funcName = reflection->getName();
+            auto layout = entryPoint->getLayout();
+            auto ep = layout->findEntryPointByName(funcName);
+            auto stage = ep->getStage();
+            if (stage == SLANG_STAGE_COMPUTE)
+            {
+                compute = true;
+            }
+            else
+            {
+                graphics = true;
+            }
+        }
+        if (compute && graphics)
+        {
+            errors << relativePath << " contains both compute and graphics entry points\n";
+            return false;
+        }
+        else
+        {
+            module = loaded;
+        }
+    }
+
+    if (diagnostics)
+    {
+        errors << (char*)diagnostics->getBufferPointer() << std::endl;
+        module = nullptr;
+        return false;
+    }
+    if (_cache && loaded)
+    {
+        cacheImports(loaded,relativePath);
+    }
+    return true;
+}
+
+uint64_t ShaderCompiler::moduleKey(const std::filesystem::path& path, const char* kind)
+{
+    //serialized IR is only readable by the Slang build that wrote it
+    uint64_t key = hashString(_globalSession->getBuildTagString(),hashString(kind));
+    key = hashCombine(key,_optionsHash);
+    key = hashCombine(key,_macrosHash);
+    return hashString(path.generic_string(),key);
+}
+
+void ShaderCompiler::loadCachedImports(const std::filesystem::path& relativePath)
+{
+    std::vector<std::filesystem::path> imports;
+    if (!_cache->loadImports(moduleKey(relativePath,"imports"),imports))
+    {
+        return;
+    }
+    for (auto& path: imports)
+    {
+        if (_cachedModules.contains(path.string()))
+        {
+            continue;
+        }
+        //a stale module also invalidates everything importing it, those are loaded from source along with it
+        CachedModule cached;
+        if (!_cache->loadModule(moduleKey(path,"module"),cached))
+        {
+            return;
+        }
+        //Slang also checks the digests it recorded of every source, which covers files edited while they were compiled
+        if (!_session->isBinaryModuleUpToDate(path.string().c_str(),cached.ir))
+        {
+            return;
+        }
+        Slang::ComPtr<IBlob> diagnostics;
+        if (!_session->loadModuleFromIRBlob(cached.name.c_str(),path.string().c_str(),cached.ir,diagnostics.writeRef()))
+        {
+            return;
+        }
+        _cachedModules.insert(path.string());
+    }
+}
+
+void ShaderCompiler::cacheImports(IModule* module, const std::filesystem::path& relativePath)
+{
+    std::set<std::filesystem::path> dependencies;
+    for (auto i=0; i<module->getDependencyFileCount(); ++i)
+    {
+        dependencies.insert(absolute(std::filesystem::path(module->getDependencyFilePath(i))));
+    }
+    //sessions only ever add modules, so each load only visits the ones it added rather than every module of the session
+    for (; _loadedModuleCount < _session->getLoadedModuleCount(); ++_loadedModuleCount)
+    {
+        auto loaded = _session->getLoadedModule(_loadedModuleCount);
+        if (loaded->getFilePath())
+        {
+            _loadedModules.emplace(absolute(std::filesystem::path(loaded->getFilePath())).string(),loaded);
+        }
+    }
+    std::vector<IModule*> imported;
+    for (auto& dependency: dependencies)
+    {
+        auto loaded = _loadedModules.find(dependency.string());
+        if (loaded != _loadedModules.end() && loaded->second != module)
+        {
+            imported.push_back(loaded->second);
+        }
+    }
+    //a module depends on every file the modules it imports depend on, so this puts imported modules first
+    std::stable_sort(imported.begin(),imported.end(),[](IModule* a, IModule* b){return a->getDependencyFileCount() < b->getDependencyFileCount();});
+
+    std::vector<std::filesystem::path> imports;
+    for (auto loaded: imported)
+    {
+        auto path = absolute(std::filesystem::path(loaded->getFilePath()));
+        imports.push_back(path);
+        if (_cachedModules.contains(path.string()))
+        {
+            continue;
+        }
+        _cachedModules.insert(path.string());
+        CachedModule cached{.name = loaded->getName()};
+        if (SLANG_FAILED(loaded->serialize(cached.ir.writeRef())))
+        {
+            continue;
+        }
+        bool hashed = true;
+        for (auto i=0; i<loaded->getDependencyFileCount() && hashed; ++i)
+        {
+            uint64_t hash = 0;
+            hashed = hashFile(loaded->getDependencyFilePath(i),hash);
+            cached.sources.push_back({absolute(std::filesystem::path(loaded->getDependencyFilePath(i))),hash});
+        }
+        if (hashed)
+        {
+            _cache->storeModule(moduleKey(path,"module"),cached);
+        }
+    }
+    _cache->storeImports(moduleKey(relativePath,"imports"),imports);
+}
+
+bool ShaderCompiler::compileModule(IModule* module, ShaderFileData& fileData, std::ostream& errors)
+{
+    std::filesystem::path file = module->getFilePath();
+    file = absolute(file);
+
+    uint64_t sourceHash = 0;
+    bool cacheable = _cache && hashModuleSources(module,sourceHash);
+    bool hasDescriptorSets = false;
+    //every entry point in order, the cache keys of each and the indices of those missing from the cache
+    std::vector<Slang::ComPtr<IEntryPoint>> entryPoints;
+    std::vector<uint64_t> cacheKeys;
+    std::vector<size_t> pending;
+
+    for (auto entryPointIndex = 0; entryPointIndex < module->getDefinedEntryPointCount(); entryPointIndex++)
+    {
+        Slang::ComPtr<IEntryPoint> entryPoint = nullptr;
+        module->getDefinedEntryPoint(entryPointIndex,entryPoint.writeRef());
+        auto reflection =entryPoint->getFunctionReflection();
+        auto funcName = reflection->getName();
+        ProfileScope reflectScope(_profiler,"reflect",funcName,module->getFilePath());
+        auto layout = entryPoint->getLayout();
+        auto ep = layout->findEntryPointByName(funcName);
+        auto stage = ep->getStage();
+        std::string stageName = "";
+        uint32_t stageFlag = 0;
+        std::vector<std::string> parameters;
+        ShaderType currentType = ShaderType::UNKNOWN;
+        GeometryPipelineType pipelineType = GeometryPipelineType::NA;
+
+        switch (stage)
+        {
+            case SLANG_STAGE_NONE:
+                errors << "encountered unknown entry point stage"<< module->getFilePath()<<": "<<reflection->getName()<<"\n";
+                return false;
+                break;
+            case SLANG_STAGE_VERTEX:
+                if (!isSameShaderType(currentType,ShaderType::GRAPHICS,pipelineType,GeometryPipelineType::VERTEX,module->getFilePath(),errors)){return false;}
+                stageName = "vertex";
+                stageFlag = shaderfax::STAGE_VERTEX;
+                parameters = getVertexParameters(reflection);
+                break;
+            case SLANG_STAGE_HULL:
+                if (!isSameShaderType(currentType,ShaderType::GRAPHICS,pipelineType,GeometryPipelineType::VERTEX,module->getFilePath(),errors)){return false;}
+                stageName = "hull";
+                stageFlag = shaderfax::STAGE_HULL;
+                parameters = getHullParameters(reflection);
+                break;
+            case SLANG_STAGE_DOMAIN:
+                if (!isSameShaderType(currentType,ShaderType::GRAPHICS,pipelineType,GeometryPipelineType::VERTEX,module->getFilePath(),errors)){return false;}
+                stageName = "domain";
+                stageFlag = shaderfax::STAGE_DOMAIN;
+                parameters = getDomainParameters(reflection);
+                break;
+            case SLANG_STAGE_GEOMETRY:
+                if (!isSameShaderType(currentType,ShaderType::GRAPHICS,pipelineType,GeometryPipelineType::VERTEX,module->getFilePath(),errors)){return false;}
+                stageName = "geometry";
+                stageFlag = shaderfax::STAGE_GEOMETRY;
+                parameters = getGeometryParameters(reflection);
+                break;
+            case SLANG_STAGE_FRAGMENT:
+                if (!isSameShaderType(currentType,ShaderType::GRAPHICS,pipelineType,GeometryPipelineType::VERTEX,module->getFilePath(),errors)){return false;}
+                stageName = "fragment";
+                stageFlag = shaderfax::STAGE_FRAGMENT;
+                if (!getFragmentParameters(reflection,parameters,file,errors))
+                {
+                    return false;
+                }
+                break;
+            case SLANG_STAGE_COMPUTE:
+                if (!isSameShaderType(currentType,ShaderType::COMPUTE,pipelineType,GeometryPipelineType::NA,module->getFilePath(),errors)){return false;}
+                stageName = "compute";
+                stageFlag = shaderfax::STAGE_COMPUTE;
+                parameters = getComputeParameters(reflection);
+                break;
+            case SLANG_STAGE_RAY_GENERATION:
+                if (!isSameShaderType(currentType,ShaderType::RAY,pipelineType,GeometryPipelineType::NA,module->getFilePath(),errors)){return false;}
+                stageName = "rayGeneration";
+                stageFlag = shaderfax::STAGE_RAY_GENERATION;
+                parameters = getRayGenerationParameters(reflection);
+                break;
+            case SLANG_STAGE_INTERSECTION:
+                if (!isSameShaderType(currentType,ShaderType::RAY,pipelineType,GeometryPipelineType::NA,module->getFilePath(),errors)){return false;}
+                stageName = "intersection";
+                stageFlag = shaderfax::STAGE_INTERSECTION;
+                parameters = getIntersectionParameters(reflection);
+                break;
+            case SLANG_STAGE_ANY_HIT:
+                if (!isSameShaderType(currentType,ShaderType::RAY,pipelineType,GeometryPipelineType::NA,module->getFilePath(),errors)){return false;}
+                stageName = "anyHit";
+                stageFlag = shaderfax::STAGE_ANY_HIT;
+                parameters = getAnyHitParameters(reflection);
+                break;
+            case SLANG_STAGE_CLOSEST_HIT:
+                if (!isSameShaderType(currentType,ShaderType::RAY,pipelineType,GeometryPipelineType::NA,module->getFilePath(),errors)){return false;}
+                stageName = "closestHit";
+                stageFlag = shaderfax::STAGE_CLOSEST_HIT;
+                parameters = getClosestHitParameters(reflection);
+                break;
+            case SLANG_STAGE_MISS:
+                if (!isSameShaderType(currentType,ShaderType::RAY,pipelineType,GeometryPipelineType::NA,module->getFilePath(),errors)){return false;}
+                stageName = "miss";
+                stageFlag = shaderfax::STAGE_MISS;
+                parameters = getMissParameters(reflection);
+                break;
+            case SLANG_STAGE_CALLABLE:
+                if (!isSameShaderType(currentType,ShaderType::RAY,pipelineType,GeometryPipelineType::NA,module->getFilePath(),errors)){return false;}
+                stageName = "callable";
+                stageFlag = shaderfax::STAGE_CALLABLE;
+                parameters = getCallableParameters(reflection);
+                break;
+            case SLANG_STAGE_MESH:
+                if (!isSameShaderType(currentType,ShaderType::RAY,pipelineType,GeometryPipelineType::MESH,module->getFilePath(),errors)){return false;}
+                stageName = "mesh";
+                stageFlag = shaderfax::STAGE_MESH;
+                parameters = getMeshParameters(reflection);
+                break;
+            case SLANG_STAGE_AMPLIFICATION:
+                if (!isSameShaderType(currentType,ShaderType::RAY,pipelineType,GeometryPipelineType::MESH,module->getFilePath(),errors)){return false;}
+                stageName = "task";
+                stageFlag = shaderfax::STAGE_TASK;
+                parameters = getAmplificationParameters(reflection);
+                break;
+            default:
+                errors << "encountered unknown entry point stage"<< module->getFilePath()<<": "<<reflection->getName()<<"\n";
+                return false;
+                break;
+
+        }
+
+        auto pushConstants = getPushConstants(module->getLayout(),ep,stageFlag);
+        reflectScope.stop();
+
+        uint64_t cacheKey = 0;
+        if (cacheable)
+        {
+            ProfileScope cacheScope(_profiler,"cache",funcName,module->getFilePath());
+            //code from another slang build may differ, so caches shared between machines keep their entries apart
+            cacheKey = hashString(_globalSession->getBuildTagString(),hashString(funcName,sourceHash));
+            cacheKey = hashCombine(hashCombine(hashCombine(cacheKey,stage),_optionsHash),_macrosHash);
+            ShaderOutData cached{};
+            std::vector<DescriptorSet> cachedSets;
+            if (_cache->load(cacheKey,cached,cachedSets))
+            {
+                cached.pushConstants = pushConstants;
+                cached.stageFlag = stageFlag;
+                if (!hasDescriptorSets)
+                {
+                    fileData.descriptorSets = std::move(cachedSets);
+                    hasDescriptorSets = true;
+                }
+                fileData.shaderOutData.push_back(std::move(cached));
+                entryPoints.push_back(entryPoint);
+                cacheKeys.push_back(cacheKey);
+                continue;
+            }
+        }
+        pending.push_back(fileData.shaderOutData.size());
+        fileData.shaderOutData.push_back({.stage = stageName,.parameters = std::move(parameters),.pushConstants = pushConstants,.stageFlag = stageFlag});
+        entryPoints.push_back(entryPoint);
+        cacheKeys.push_back(cacheKey);
+    }
+
+    //a shared module holds every stage, so it is generated again as a whole if any stage is missing from the cache
+    if (_settings.link == LinkMode::SHARED && !pending.empty() && pending.size() != entryPoints.size())
+    {
+        pending.clear();
+        for (auto i=0; i<entryPoints.size(); ++i)
+        {
+            fileData.shaderOutData[i].spirvCode = nullptr;
+            fileData.shaderOutData[i].targetCode.clear();
+            fileData.shaderOutData[i].entryPoint.clear();
+            pending.push_back(i);
+        }
+    }
+    if (!generateCode(module,entryPoints,pending,fileData,errors))
+    {
+        return false;
+    }
+    for (auto index: pending)
+    {
+        if (cacheable)
+        {
+            if (!hasDescriptorSets)
+            {
+                reflectDescriptorSets(module,fileData.descriptorSets);
+                hasDescriptorSets = true;
+            }
+            _cache->store(cacheKeys[index],fileData.shaderOutData[index],fileData.descriptorSets);
+        }
+    }
+    if (!hasDescriptorSets)
+    {
+        reflectDescriptorSets(module,fileData.descriptorSets);
+    }
+    return true;
+}
+
+bool ShaderCompiler::generateCode(IModule* module, std::vector<Slang::ComPtr<IEntryPoint>>& entryPoints, const std::vector<size_t>& pending, ShaderFileData& fileData, std::ostream& errors)
+{
+    auto storeCode = [&](ShaderOutData& outData, size_t target, const Slang::ComPtr<IBlob>& code)
+    {
+        if (target == 0)
+        {
+            outData.spirvCode = code;
+        }
+        else
+        {
+            outData.targetCode.push_back({.target = _settings.targets[target - 1],.code = code});
+        }
+    };
+    auto targetCount = _settings.targets.size() + 1;
+    Slang::ComPtr<IBlob> code;
+    Slang::ComPtr<IBlob> diagnostics;
+
+    if (_settings.link == LinkMode::SEPARATE)
+    {
+        for (auto index: pending)
+        {
+            auto name = entryPoints[index]->getFunctionReflection()->getName();
+            ProfileScope linkScope(_profiler,"link",name,module->getFilePath());
+            Slang::ComPtr<IComponentType> program;
+            diagnostics = nullptr;
+            entryPoints[index]->link(program.writeRef(),diagnostics.writeRef());
+            linkScope.stop();
+            if (diagnostics.get())
+            {
+                errors<<(char*)diagnostics->getBufferPointer()<<"\n";
+                return false;
+            }
+            //the other targets reuse the linked program, only code generation runs per target
+            ProfileScope codeScope(_profiler,"codegen",name,module->getFilePath());
+            for (auto target=0; target<targetCount; ++target)
+            {
+                if (!getCode(program,-1,target,code,errors))
+                {
+                    return false;
+                }
+                storeCode(fileData.shaderOutData[index],target,code);
+            }
+        }
+        return true;
+    }
+
+    if (pending.empty())
+    {
+        return true;
+    }
+    //link every entry point together once, so the module body is linked a single time rather than once per stage
+    std::vector<IComponentType*> components;
+    for (auto index: pending)
+    {
+        components.push_back(entryPoints[index]);
+    }
+    ProfileScope linkScope(_profiler,"link",std::filesystem::path(module->getFilePath()).filename().string(),module->getFilePath());
+    Slang::ComPtr<IComponentType> composite;
+    Slang::ComPtr<IComponentType> program;
+    _session->createCompositeComponentType(components.data(),components.size(),composite.writeRef(),diagnostics.writeRef());
+    if (!diagnostics.get() && composite.get())
+    {
+        composite->link(program.writeRef(),diagnostics.writeRef());
+    }
+    if (diagnostics.get() || !program.get())
+    {
+        if (diagnostics.get())
+        {
+            errors<<(char*)diagnostics->getBufferPointer()<<"\n";
+        }
+        return false;
+    }
+    linkScope.stop();
+
+    ProfileScope codeScope(_profiler,"codegen",std::filesystem::path(module->getFilePath()).filename().string(),module->getFilePath());
+    for (auto target=0; target<targetCount; ++target)
+    {
+        if (_settings.link == LinkMode::SHARED)
+        {
+            //one module with an entry point per stage, every stage points at the same code
+            if (!getCode(program,-1,target,code,errors))
+            {
+                return false;
+            }
+            for (auto index: pending)
+            {
+                storeCode(fileData.shaderOutData[index],target,code);
+            }
+            continue;
+        }
+        for (auto i=0; i<pending.size(); ++i)
+        {
+            if (!getCode(program,i,target,code,errors))
+            {
+                return false;
+            }
+            storeCode(fileData.shaderOutData[pending[i]],target,code);
+        }
+    }
+    if (_settings.link == LinkMode::SHARED)
+    {
+        for (auto index: pending)
+        {
+            fileData.shaderOutData[index].entryPoint = entryPoints[index]->getFunctionReflection()->getName();
+        }
+    }
+    return true;
+}
+
+void ShaderCompiler::reflectDescriptorSets(IModule* module, std::vector<DescriptorSet>& descriptorSets)
+{
+    ProfileScope scope(_profiler,"reflect","descriptor sets",module->getFilePath());
+    auto layout = module->getLayout();
+    auto parameterCount = layout->getParameterCount();
+
+    for (auto i=0; i<parameterCount; i++)
+    {
+        auto parameter = layout->getParameterByIndex(i);
+        auto paramType = parameter->getType();
+        auto paramKind = paramType->getKind();
+        if (paramKind == TypeReflection::Kind::ParameterBlock)
+        {
+            auto paramName = parameter->getName();
+            auto paramLayout = parameter->getTypeLayout();
+
+            auto blockTypeLayout = paramLayout->getElementTypeLayout();
+
+            descriptorSets.push_back(DescriptorSet(paramName,blockTypeLayout,descriptorSets.size()));
+        }
+
+    }
+}
+
+void ShaderCompiler::getDependencies(IModule* module, std::vector<std::filesystem::path>& dependencies)
+{
+    for (auto i=0; i<module->getDependencyFileCount(); ++i)
+    {
+        dependencies.push_back(absolute(std::filesystem::path(module->getDependencyFilePath(i))));
+    }
+}
+
+uint64_t ShaderCompiler::optionsHash(const CompileSettings& settings)
+{
+    std::vector<TargetDesc> targets;
+    SlangMatrixLayoutMode matrixLayout;
+    std::vector<CompilerOptionEntry> compilerOptions;
+    getSessionOptions(settings,targets,matrixLayout,compilerOptions);
+
+    uint64_t hash = hashCombine(targets[0].format,matrixLayout);
+    for (auto i=1; i<targets.size(); ++i)
+    {
+        hash = hashCombine(hash,targets[i].format);
+    }
+    if (settings.link != LinkMode::SEPARATE)
+    {
+        hash = hashCombine(hash,(uint32_t)settings.link);
+    }
+    for (auto& option: compilerOptions)
+    {
+        hash = hashCombine(hash,(uint64_t)option.name);
+        hash = hashCombine(hash,(uint64_t)option.value.kind);
+        hash = hashCombine(hash,option.value.intValue0);
+        hash = hashCombine(hash,option.value.intValue1);
+        hash = hashString(option.value.stringValue0 ? option.value.stringValue0 : "",hash);
+        hash = hashString(option.value.stringValue1 ? option.value.stringValue1 : "",hash);
+    }
+    return hash;
+}
+
+bool hashModuleSources(IModule* module, uint64_t& hash)
+{
+    hash = 0;
+    for (auto i=0; i<module->getDependencyFileCount(); ++i)
+    {
+        uint64_t fileHash = 0;
+        if (!hashFile(module->getDependencyFilePath(i),fileHash))
+        {
+            return false;
+        }
+        hash = hashCombine(hash,fileHash);
+    }
+    return true;
+}
+
+PushConstantRange getPushConstants(ShaderReflection* layout, EntryPointReflection* entryPoint, uint32_t stageFlag)
+{
+    //Vulkan allows a single push constant block per stage, uniform entry point parameters are placed there by slang
+    TypeLayoutReflection* block = nullptr;
+    auto entryPointLayout = entryPoint->getVarLayout() ? entryPoint->getVarLayout()->getTypeLayout() : nullptr;
+    if (entryPointLayout && isPushConstantBlock(entryPointLayout))
+    {
+        block = entryPointLayout;
+    }
+    for (auto i=0; !block && layout && i<layout->getParameterCount(); ++i)
+    {
+        auto typeLayout = layout->getParameterByIndex(i)->getTypeLayout();
+        if (isPushConstantBlock(typeLayout))
+        {
+            block = typeLayout;
+        }
+    }
+    if (!block || !block->getElementTypeLayout())
+    {
+        return {};
+    }
+    //fields may start past zero with [[vk::offset]], the range then only covers the bytes the stage reads
+    auto elementLayout = block->getElementTypeLayout();
+    size_t offset = elementLayout->getFieldCount() > 0 ? SIZE_MAX : 0;
+    for (auto i=0; i<elementLayout->getFieldCount(); ++i)
+    {
+        offset = std::min(offset,elementLayout->getFieldByIndex(i)->getOffset());
+    }
+    size_t size = elementLayout->getSize();
+    if (size <= offset)
+    {
+        return {};
+    }
+    //VkPushConstantRange sizes and offsets are multiples of 4
+    offset &= ~size_t(3);
+    return {.stages = stageFlag,.offset = (uint32_t)offset,.size = (uint32_t)((size - offset + 3) & ~size_t(3))};
+}
+
+bool isPushConstantBlock(TypeLayoutReflection* typeLayout)
+{
+    for (auto i=0; i<typeLayout->getCategoryCount(); ++i)
+    {
+        if (typeLayout->getCategoryByIndex(i) == ParameterCategory::PushConstantBuffer)
+        {
+            return true;
+        }
+    }
+    return typeLayout->getParameterCategory() == ParameterCategory::PushConstantBuffer;
+}
+
+void getSessionOptions(const CompileSettings& settings, std::vector<TargetDesc>& targets, SlangMatrixLayoutMode& matrixLayout, std::vector<CompilerOptionEntry>& compilerOptions)
+{
+    //SPIR-V is always target 0, the code every stage ships with
+    targets.push_back({.format = SLANG_SPIRV});
+    for (auto target: settings.targets)
+    {
+        switch (target)
+        {
+            case shaderfax::CODE_TARGET_GLSL:
+                targets.push_back({.format = SLANG_GLSL});
+                break;
+            case shaderfax::CODE_TARGET_HLSL:
+                targets.push_back({.format = SLANG_HLSL});
+                break;
+            case shaderfax::CODE_TARGET_CPP:
+                //entry points as C++ functions that run on the CPU, SLANG_HOST_CPP_SOURCE is for host code without entry points
+                targets.push_back({.format = SLANG_CPP_SOURCE});
+                break;
+        }
+    }
+    matrixLayout = SLANG_MATRIX_LAYOUT_COLUMN_MAJOR;
+    compilerOptions.push_back(CompilerOptionEntry(CompilerOptionName::PreserveParameters,CompilerOptionValue(CompilerOptionValueKind::Int,true)));
+    compilerOptions.push_back(CompilerOptionEntry(CompilerOptionName::Optimization,CompilerOptionValue(CompilerOptionValueKind::Int,settings.optimization)));
+    compilerOptions.push_back(CompilerOptionEntry(CompilerOptionName::DebugInformation,CompilerOptionValue(CompilerOptionValueKind::Int,settings.debugInfo)));
+    if (settings.link == LinkMode::SHARED)
+    {
+        //stages of a shared module are told apart by their function names rather than all being called main
+        compilerOptions.push_back(CompilerOptionEntry(CompilerOptionName::VulkanUseEntryPointName,CompilerOptionValue(CompilerOptionValueKind::Int,true)));
+    }
+}
+
+bool isSameShaderType(ShaderType& existingType, ShaderType comparisonType, GeometryPipelineType& existingPipeline, GeometryPipelineType comparisonPipeline, const std::filesystem::path& currentFile, std::ostream& errors)
+{
+    if (existingType == ShaderType::UNKNOWN)
+    {
+        existingType = comparisonType;
+        existingPipeline = comparisonPipeline;
+        return true;
+    }
+    else
+    {
+        if (existingType == comparisonType)
+        {
+            if (comparisonPipeline == GeometryPipelineType::NA)
+            {
+                return true;
+            }
+            else if (existingPipeline == GeometryPipelineType::NA)
+            {
+                existingPipeline = comparisonPipeline;
+                return true;
+            }
+            else
+            {
+                errors << "Shader defines multiple pipeline geometry execution paths";
+                return false;
+            }
+
+        }
+        errors << "Shader defines multiple pipelines: "<<currentFile<<"\n";
+        return false;
+    }
+}
+
+
+std::vector<std::string> getVertexParameters(FunctionReflection* reflection)
+{
+    std::vector<std::string> parameters;
+    auto parameterCount = reflection->getParameterCount();
+    for (auto i = 0; i < parameterCount; i++)
+    {
+        auto parameter = reflection->getParameterByIndex(i);
+        std::string inputType = parameter->getType()->getName();
+        if (inputType == "Vertex3D")
+        {
+            parameters.push_back(inputType);
+        }
+        else if (inputType == "Vertex2D")
+        {
+            parameters.push_back(inputType);
+        }
+        else if (inputType == "Normal")
+        {
+            parameters.push_back(inputType);
+        }
+        else if (inputType == "Tangent")
+        {
+            parameters.push_back(inputType);
+        }
+        else if (inputType == "UVCoordinates")
+        {
+            parameters.push_back(inputType);
+        }
+        else if (inputType == "VertexColor")
+        {
+            parameters.push_back(inputType);
+        }
+        else if (inputType == "BoneWeights")
+        {
+            parameters.push_back(inputType);
+        }
+    }
+
+    return parameters;
+}
+std::vector<std::string> getHullParameters(FunctionReflection* reflection)
+{
+    return std::vector<std::string>();
+}
+std::vector<std::string> getDomainParameters(FunctionReflection* reflection)
+{
+    return std::vector<std::string>();
+}
+std::vector<std::string> getGeometryParameters(FunctionReflection* reflection)
+{
+    return std::vector<std::string>();
+}
+bool getFragmentParameters(FunctionReflection* reflection, std::vector<std::string>& parameters, const std::filesystem::path& currentFile, std::ostream& errors)
+{
+    auto attributeCount = reflection->getUserAttributeCount();
+    std::unordered_map<uint8_t,std::string> colorTargets;
+    std::string depthTarget="";
+    bool foundDepth = false;
+    if (attributeCount)
+    {
+
+        for (auto i = 0; i < attributeCount; i++)
+        {
+            auto attribute = reflection->getUserAttributeByIndex(i);
+            std::string attributeName = attribute->getName();
+            if (attributeName=="OutputColorTarget")
+            {
+                int index = 0;
+                auto v = attribute->getArgumentValueInt(0,&index);
+                int type = 0;
+                attribute->getArgumentValueInt(1,&type);
+                auto target = TexelText[(TexelFormat)type];
+                colorTargets[index] = target;
+            }
+            else if (attributeName=="OutputDepthTarget")
+            {
+                if (!foundDepth)
+                {
+                    foundDepth = true;
+                }
+                else
+                {
+                    errors << "Multiple Depth targets defined for fragment stage: "<<currentFile<<"\n";
+                    return false;
+                }
+                int type = 0;
+                attribute->getArgumentValueInt(0,&type);
+                depthTarget = TexelText[(TexelFormat)type];
+            }
+        }
+    }
+    if (colorTargets.size()==0&&!foundDepth)
+    {
+        parameters.push_back("R8G8B8A8_UNORM");
+        parameters.push_back("D32_FLOAT");
+    }
+    else
+    {
+        for (auto& kvPair: colorTargets)
+        {
+            parameters.push_back(kvPair.second);
+        }
+        if (foundDepth)
+        {
+            parameters.push_back(depthTarget);
+        }
+    }
+    return true;
+}
+std::vector<std::string> getComputeParameters(FunctionReflection* reflection)
+{
+    return std::vector<std::string>();
+}
+std::vector<std::string> getRayGenerationParameters(FunctionReflection* reflection)
+{
+    return std::vector<std::string>();
+}
+std::vector<std::string> getIntersectionParameters(FunctionReflection* reflection)
+{
+    return std::vector<std::string>();
+}
+std::vector<std::string> getAnyHitParameters(FunctionReflection* reflection)
+{
+    return std::vector<std::string>();
+}
+std::vector<std::string> getClosestHitParameters(FunctionReflection* reflection)
+{
+    return std::vector<std::string>();
+}
+std::vector<std::string> getMissParameters(FunctionReflection* reflection)
+{
+    return std::vector<std::string>();
+}
+std::vector<std::string> getCallableParameters(FunctionReflection* reflection)
+{
+    return std::vector<std::string>();
+}
+std::vector<std::string> getMeshParameters(FunctionReflection* reflection)
+{
+    return std::vector<std::string>();
+}
+std::vector<std::string> getAmplificationParameters(FunctionReflection* reflection)
+{
+    return std::vector<std::string>();
+}
+
+bool isValidColorTarget(const std::string& colorTarget)
+{
+    if( colorTarget == "R32G32B32A32_FLOAT"){return true;}
+    else if( colorTarget == "R32G32B32A32_UINT"){return true;}
+    else if( colorTarget == "R32G32B32A32_SINT"){return true;}
+    else if( colorTarget == "R32G32B32_FLOAT"){return true;}
+    else if( colorTarget == "R32G32B32_UINT"){return true;}
+    else if( colorTarget == "R32G32B32_SINT"){return true;}
+    else if( colorTarget == "R16G16B16A16_FLOAT"){return true;}
+    else if( colorTarget == "R16G16B16A16_UNORM"){return true;}
+    else if( colorTarget == "R16G16B16A16_UINT"){return true;}
+    else if( colorTarget == "R16G16B16A16_SNORM"){return true;}
+    else if( colorTarget == "R16G16B16A16_SINT"){return true;}
+    else if( colorTarget == "R32G32_FLOAT"){return true;}
+    else if( colorTarget == "R32G32_UINT"){return true;}
+    else if( colorTarget == "R32G32_SINT"){return true;}
+    else if( colorTarget == "R10G10B10A2_UNORM"){return true;}
+    else if( colorTarget == "R10G10B10A2_UINT"){return true;}
+    else if( colorTarget == "R11G11B10_FLOAT"){return true;}
+    else if( colorTarget == "R8G8B8A8_UNORM"){return true;}
+    else if( colorTarget == "R8G8B8A8_UNORM_SRGB"){return true;}
+    else if( colorTarget == "R8G8B8A8_UINT"){return true;}
+    else if( colorTarget == "R8G8B8A8_SNORM"){return true;}
+    else if( colorTarget == "R8G8B8A8_SINT"){return true;}
+    else if( colorTarget == "R16G16_FLOAT"){return true;}
+    else if( colorTarget == "R16G16_UNORM"){return true;}
+    else if( colorTarget == "R16G16_UINT"){return true;}
+    else if( colorTarget == "R16G16_SNORM"){return true;}
+    else if( colorTarget == "R16G16_SINT"){return true;}
+    else if( colorTarget == "R32_FLOAT"){return true;}
+    else if( colorTarget == "R32_UINT"){return true;}
+    else if( colorTarget == "R32_SINT"){return true;}
+    else if( colorTarget == "R8G8_UNORM"){return true;}
+    else if( colorTarget == "R8G8_UINT"){return true;}
+    else if( colorTarget == "R8G8_SNORM"){return true;}
+    else if( colorTarget == "R8G8_SINT"){return true;}
+    else if( colorTarget == "R16_FLOAT"){return true;}
+    else if( colorTarget == "R16_UNORM"){return true;}
+    else if( colorTarget == "R16_UINT"){return true;}
+    else if( colorTarget == "R16_SNORM"){return true;}
+    else if( colorTarget == "R16_SINT"){return true;}
+    else if( colorTarget == "R8_UNORM"){return true;}
+    else if( colorTarget == "R8_UINT"){return true;}
+    else if( colorTarget == "R8_SNORM"){return true;}
+    else if( colorTarget == "R8_SINT"){return true;}
+    else if( colorTarget == "A8_UNORM"){return true;}
+    else if( colorTarget == "R9G9B9E5_SHAREDEXP"){return true;}
+    else if( colorTarget == "R8G8_B8G8_UNORM"){return true;}
+    else if( colorTarget == "G8R8_G8B8_UNORM"){return true;}
+    else if( colorTarget == "BC1_UNORM"){return true;}
+    else if( colorTarget == "BC1_UNORM_SRGB"){return true;}
+    else if( colorTarget == "BC2_UNORM"){return true;}
+    else if( colorTarget == "BC2_UNORM_SRGB"){return true;}
+    else if( colorTarget == "BC3_UNORM"){return true;}
+    else if( colorTarget == "BC3_UNORM_SRGB"){return true;}
+    else if( colorTarget == "BC4_UNORM"){return true;}
+    else if( colorTarget == "BC4_SNORM"){return true;}
+    else if( colorTarget == "BC5_UNORM"){return true;}
+    else if( colorTarget == "BC5_SNORM"){return true;}
+    else if( colorTarget == "B5G6R5_UNORM"){return true;}
+    else if( colorTarget == "B5G5R5A1_UNORM"){return true;}
+    else if( colorTarget == "B8G8R8A8_UNORM"){return true;}
+    else if( colorTarget == "B8G8R8X8_UNORM"){return true;}
+    else if( colorTarget == "B8G8R8A8_UNORM_SRGB"){return true;}
+    else if( colorTarget == "B8G8R8X8_UNORM_SRGB"){return true;}
+    else if( colorTarget == "BC6H_UF16"){return true;}
+    else if( colorTarget == "BC6H_SF16"){return true;}
+    else if( colorTarget == "BC7_UNORM"){return true;}
+    else if( colorTarget == "BC7_UNORM_SRGB"){return true;}
+    else if( colorTarget == "AYUV"){return true;}
+    else if( colorTarget == "NV12"){return true;}
+    else if( colorTarget == "OPAQUE_420"){return true;}
+    else if( colorTarget == "YUY2"){return true;}
+    else if( colorTarget == "B4G4R4A4_UNORM"){return true;}
+    return false;
+
+}
+
+bool isValidDepthTarget(const std::string & depthTarget)
+{
+    if( depthTarget == "D32_FLOAT_S8X24_UINT"){return true;}
+    else if( depthTarget == "D32_FLOAT"){return true;}
+    else if( depthTarget == "D24_UNORM_S8_UINT"){return true;}
+    else if( depthTarget == "D16_UNORM"){return true;}
+    else if( depthTarget == "none"){return true;}
+    return false;
+}
+
+bool getCode(IComponentType* program, SlangInt entryPointIndex, SlangInt targetIndex, Slang::ComPtr<IBlob>& code, std::ostream& errors)
+{
+    code = nullptr;
+    Slang::ComPtr<IBlob> diagnostics;
+    if (entryPointIndex < 0)
+    {
+        program->getTargetCode(targetIndex,code.writeRef(),diagnostics.writeRef());
+    }
+    else
+    {
+        program->getEntryPointCode(entryPointIndex,targetIndex,code.writeRef(),diagnostics.writeRef());
+    }
+    if (code.get() == nullptr)
+    {
+        if (diagnostics.get())
+        {
+            errors<<(char*)diagnostics->getBufferPointer()<<"\n";
+        }
+        return false;
+    }
+    return true;
+}
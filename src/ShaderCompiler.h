@@ -0,0 +1,99 @@
+#ifndef SHADERFAX_SHADERCOMPILER_H
+#define SHADERFAX_SHADERCOMPILER_H
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <slang.h>
+#include <slang-com-ptr.h>
+#include <shaderfax/CshdrFormat.h>
+
+#include "ShaderCache.h"
+#include "Profiler.h"
+#include "ShaderFileData.h"
+#include "VariantMatrix.h"
+
+///How the entry points of a module are linked
+enum class LinkMode
+{
+  ///Each entry point is linked on its own into a module of its own
+  SEPARATE,
+  ///Every entry point of the module is linked once together, the code of each is then generated on its own
+  COMPOSITE,
+  ///Every entry point of the module is linked once together into a single module that all stages share
+  SHARED
+};
+
+///Session options chosen on the command line
+struct CompileSettings
+{
+  SlangOptimizationLevel optimization = SLANG_OPTIMIZATION_LEVEL_DEFAULT;
+  SlangDebugInfoLevel debugInfo = SLANG_DEBUG_INFO_LEVEL_NONE;
+  ///Targets compiled besides SPIR-V. They share the session, so modules are parsed, checked and linked once for all of them
+  std::vector<shaderfax::CodeTarget> targets;
+  LinkMode link = LinkMode::SEPARATE;
+};
+
+///Owns a Slang global session and session. Slang sessions are not thread safe, so every thread compiling shaders needs its own compiler
+class ShaderCompiler
+{
+private:
+  std::filesystem::path _root;
+  std::string _searchPath;
+  CompileSettings _settings;
+  std::vector<ShaderMacro> _macros;
+  uint64_t _macrosHash = 0;
+  Slang::ComPtr<slang::IGlobalSession> _globalSession;
+  Slang::ComPtr<slang::ISession> _session;
+  Slang::ComPtr<ISlangFileSystem> _fileSystem;
+  uint64_t _optionsHash = 0;
+  ShaderCache* _cache = nullptr;
+  Profiler* _profiler = nullptr;
+  ///Imported modules of the current session that were loaded from the cache or are already in it
+  std::unordered_set<std::string> _cachedModules;
+  ///Modules of the current session loaded from a file by absolute path, and how many of the session's modules are in it
+  std::unordered_map<std::string,slang::IModule*> _loadedModules;
+  SlangInt _loadedModuleCount = 0;
+  void createSession();
+  ///Loads a module from its file, or from source if it isn't null
+  bool loadModule(const std::filesystem::path& relativePath, const std::string* source, slang::IModule*& module, std::ostream& errors);
+  uint64_t moduleKey(const std::filesystem::path& path, const char* kind);
+  ///Loads the modules the module imported last time from their cached IR, so importing them finds them already loaded
+  void loadCachedImports(const std::filesystem::path& relativePath);
+  ///Serializes every module the module imported that was loaded from source, and remembers which ones it imported
+  void cacheImports(slang::IModule* module, const std::filesystem::path& relativePath);
+  void reflectDescriptorSets(slang::IModule* module, std::vector<DescriptorSet>& descriptorSets);
+  ///Generates the code of the pending entries of fileData, linking their entry points as the settings say
+  bool generateCode(slang::IModule* module, std::vector<Slang::ComPtr<slang::IEntryPoint>>& entryPoints, const std::vector<size_t>& pending, ShaderFileData& fileData, std::ostream& errors);
+public:
+  ///Sources are read from the file system if one is given, with root as its search path, and from disk otherwise
+  ShaderCompiler(const std::filesystem::path& root, const CompileSettings& settings = {}, ISlangFileSystem* fileSystem = nullptr);
+  ///Replaces the session, keeping the global session, so modules edited since they were loaded are read again
+  void resetSession();
+  ///Preprocessor macros defined for every module loaded afterwards. Slang reads macros once per session, so changing them
+  ///replaces the session
+  void setMacros(const std::vector<ShaderMacro>& macros);
+  ///Entry points found in the cache skip linking and code generation, imported modules found in it skip parsing and
+  ///checking. The cache may be shared between compilers. Compilers reading sources from a file system don't use it, as the
+  ///cache tells whether entries are stale from the files on disk
+  void setCache(ShaderCache* cache);
+  ///Records the time spent loading, reflecting, linking and generating code of every module. The profiler may be shared
+  ///between compilers
+  void setProfiler(Profiler* profiler);
+  ///Loads a module relative to the root folder. Modules without entry points are libraries and produce no output
+  bool loadModule(const std::filesystem::path& relativePath, slang::IModule*& module, std::ostream& errors);
+  ///Loads a module from source text instead of its file. Imports are found as if the module was at relativePath
+  bool loadModuleFromSource(const std::filesystem::path& relativePath, const std::string& source, slang::IModule*& module, std::ostream& errors);
+  ///Reflects and links every entry point of the module
+  bool compileModule(slang::IModule* module, ShaderFileData& fileData, std::ostream& errors);
+  ///Absolute paths of every file the module was built from, including the module itself and everything it imports
+  static void getDependencies(slang::IModule* module, std::vector<std::filesystem::path>& dependencies);
+  ///Hash of every session option that affects the compiled output
+  static uint64_t optionsHash(const CompileSettings& settings);
+};
+
+#endif //SHADERFAX_SHADERCOMPILER_H
@@ -0,0 +1,75 @@
+#ifndef SHADERFAX_SHADERFILEDATA_H
+#define SHADERFAX_SHADERFILEDATA_H
+#include <string>
+#include <vector>
+
+#include <slang.h>
+#include <slang-com-ptr.h>
+
+#include "DescriptorSet.h"
+
+///Code of an entry point for a target besides SPIR-V
+struct TargetCode
+{
+  ///Value of shaderfax::CodeTarget
+  uint32_t target = 0;
+  Slang::ComPtr<slang::IBlob> code=nullptr;
+};
+
+///Push constant block of a stage's code, bytes [offset, offset + size) of the push constants
+struct PushConstantRange
+{
+  ///Value of shaderfax::StageFlags
+  uint32_t stages = 0;
+  uint32_t offset = 0;
+  ///Zero if the stage has no push constants
+  uint32_t size = 0;
+  bool operator==(const PushConstantRange&) const = default;
+};
+
+///Compiled output of a single entry point
+struct ShaderOutData
+{
+  std::string stage;
+  std::vector<std::string> parameters;
+  Slang::ComPtr<slang::IBlob> spirvCode=nullptr;
+  ///Code for every additional target, in the order the targets were requested
+  std::vector<TargetCode> targetCode;
+  ///Name of the entry point in the code when several stages share it, empty for code holding one entry point called main
+  std::string entryPoint;
+  PushConstantRange pushConstants;
+  ///Value of shaderfax::StageFlags
+  uint32_t stageFlag = 0;
+};
+
+///Macro of a variant matrix and the values it is compiled with. A variant key holds the index of the value in bits
+///[shift, shift + bits)
+struct VariantAxis
+{
+  std::string name;
+  std::vector<std::string> values;
+  uint32_t shift = 0;
+  uint32_t bits = 0;
+};
+
+///Ranges of shaderOutData and descriptorSets compiled for one combination of the variant matrix
+struct ShaderVariant
+{
+  uint32_t key = 0;
+  uint32_t firstStage = 0;
+  uint32_t stageCount = 0;
+  uint32_t firstDescriptorSet = 0;
+  uint32_t descriptorSetCount = 0;
+};
+
+///Everything written to a single .cshdr file
+struct ShaderFileData
+{
+  std::vector<ShaderOutData> shaderOutData;
+  std::vector<DescriptorSet> descriptorSets;
+  ///Empty unless the module declares a variant matrix, then every combination's stages follow each other in shaderOutData
+  std::vector<VariantAxis> variantAxes;
+  std::vector<ShaderVariant> variants;
+};
+
+#endif //SHADERFAX_SHADERFILEDATA_H
@@ -0,0 +1,463 @@
+#include "ShaderFileWriter.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+
+#include <shaderfax/SpirvCodec.h>
+
+#include "Hash.h"
+#include "LayoutTableWriter.h"
+
+using namespace shaderfax;
+
+ShaderFileWriter::ShaderFileWriter(ShaderFileData& fileData, ShaderFileFormat format, shaderfax::BlobEncoding encoding, bool sharedLayouts)
+{
+    if (format == ShaderFileFormat::V2)
+    {
+        serializeV2(fileData,encoding,sharedLayouts);
+    }
+    else
+    {
+        serializeV1(fileData);
+    }
+}
+
+void ShaderFileWriter::serializeV1(ShaderFileData& fileData)
+{
+    //size the metadata exactly so it is allocated once and segment offsets stay valid
+    size_t metadataSize = sizeof(CSHDR_V1_MAGIC) + sizeof(uint8_t);
+    for (auto& descriptorSet: fileData.descriptorSets)
+    {
+        metadataSize += sizeof(uint8_t);
+        for (auto i=0; i< descriptorSet.descriptorCount(); ++i)
+        {
+            metadataSize += descriptorSet.at(i).name.size() + 1 + sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint32_t);
+        }
+    }
+    for (auto& stage: fileData.shaderOutData)
+    {
+        metadataSize += stage.stage.size() + 3 + sizeof(uint32_t);
+        for (auto i=0; i<stage.parameters.size(); ++i)
+        {
+            metadataSize += stage.parameters[i].size() + (i<stage.parameters.size()-1 ? 1 : 0);
+        }
+    }
+    reserveMetadata(metadataSize);
+
+    appendMetadata(CSHDR_V1_MAGIC,sizeof(CSHDR_V1_MAGIC));
+    appendValue<uint8_t>(fileData.descriptorSets.size());
+    for (auto& descriptorSet: fileData.descriptorSets)
+    {
+        appendValue<uint8_t>(descriptorSet.descriptorCount());
+        for (auto i=0; i< descriptorSet.descriptorCount(); ++i)
+        {
+            auto& descriptor = descriptorSet.at(i);
+            appendMetadata(descriptor.name.c_str(),descriptor.name.size()+1);
+            appendValue<uint32_t>(descriptor.index);
+            appendValue<uint8_t>(descriptor.type);
+            appendValue<uint32_t>(descriptor.count);
+        }
+    }
+    for (auto& stage: fileData.shaderOutData)
+    {
+        appendMetadata(stage.stage.data(),stage.stage.size());
+        appendMetadata(":<",2);
+        for (auto i=0; i<stage.parameters.size(); ++i)
+        {
+            appendMetadata(stage.parameters[i].data(),stage.parameters[i].size());
+            if (i<stage.parameters.size()-1)
+            {
+                appendMetadata(",",1);
+            }
+        }
+        appendMetadata(">",1);
+        appendValue<uint32_t>(stage.spirvCode->getBufferSize());
+        appendData(stage.spirvCode->getBufferPointer(),stage.spirvCode->getBufferSize());
+    }
+}
+
+void ShaderFileWriter::serializeV2(ShaderFileData& fileData, BlobEncoding encoding, bool sharedLayouts)
+{
+    std::vector<char> strings;
+    std::unordered_map<std::string,StringRef> internedStrings;
+    auto intern = [&](const std::string& text)
+    {
+        auto found = internedStrings.find(text);
+        if (found != internedStrings.end())
+        {
+            return found->second;
+        }
+        StringRef reference{.offset = (uint32_t)strings.size(),.size = (uint32_t)text.size()};
+        strings.insert(strings.end(),text.c_str(),text.c_str()+text.size()+1);
+        internedStrings.emplace(text,reference);
+        return reference;
+    };
+
+    std::vector<StageRecord> stages;
+    std::vector<StringRef> parameters;
+    std::vector<BlobRecord> blobs;
+    std::vector<uint64_t> blobIds;
+    std::vector<const char*> blobData;
+    std::vector<slang::IBlob*> blobSources;
+    std::unordered_map<uint64_t,uint32_t> blobIndices;
+    auto addBlob = [&](slang::IBlob* source)
+    {
+        auto code = (const char*)source->getBufferPointer();
+        auto codeSize = source->getBufferSize();
+        auto blobId = hashBytes(code,codeSize);
+
+        //stages with identical code share one blob
+        auto existing = blobIndices.find(blobId);
+        if (existing != blobIndices.end())
+        {
+            auto existingSource = blobSources[existing->second];
+            if (existingSource->getBufferSize() == codeSize && std::memcmp(existingSource->getBufferPointer(),code,codeSize) == 0)
+            {
+                _duplicateBytes += blobs[existing->second].size;
+                return existing->second;
+            }
+        }
+        uint32_t index = blobs.size();
+        blobIndices.emplace(blobId,index);
+
+        BlobRecord blob{.offset = 0,.size = (uint32_t)codeSize,.encoding = BLOB_ENCODING_NONE};
+        if (encoding == BLOB_ENCODING_SPIRV && codeSize % sizeof(uint32_t) == 0)
+        {
+            std::vector<char> encoded;
+            //blobs that aren't SPIR-V, or don't get smaller, are stored as they are
+            if (encodeSpirv({(const uint32_t*)code,codeSize/sizeof(uint32_t)},encoded) && encoded.size() < codeSize)
+            {
+                blob.size = encoded.size();
+                blob.encoding = BLOB_ENCODING_SPIRV;
+                code = _encodedBlobs.emplace_back(std::move(encoded)).data();
+            }
+        }
+        blobs.push_back(blob);
+        blobIds.push_back(blobId);
+        blobData.push_back(code);
+        blobSources.push_back(source);
+        return index;
+    };
+    std::vector<TargetCodeRecord> targetCode;
+    std::vector<StringRef> entryPoints;
+    bool namedEntryPoints = std::any_of(fileData.shaderOutData.begin(),fileData.shaderOutData.end(),[](const ShaderOutData& stage){return !stage.entryPoint.empty();});
+    for (auto& stage: fileData.shaderOutData)
+    {
+        uint32_t stageIndex = stages.size();
+        stages.push_back({.stage = intern(stage.stage),.firstParameter = (uint32_t)parameters.size(),.parameterCount = (uint32_t)stage.parameters.size(),.blob = addBlob(stage.spirvCode),.reserved = 0});
+        for (auto& parameter: stage.parameters)
+        {
+            parameters.push_back(intern(parameter));
+        }
+        if (namedEntryPoints)
+        {
+            entryPoints.push_back(intern(stage.entryPoint.empty() ? "main" : stage.entryPoint));
+        }
+        for (auto& code: stage.targetCode)
+        {
+            targetCode.push_back({.stage = stageIndex,.target = code.target,.blob = addBlob(code.code),.reserved = 0});
+        }
+    }
+    std::vector<PushConstantRecord> pushConstants;
+    if (std::any_of(fileData.shaderOutData.begin(),fileData.shaderOutData.end(),[](const ShaderOutData& stage){return stage.pushConstants.size > 0;}))
+    {
+        for (auto& stage: fileData.shaderOutData)
+        {
+            pushConstants.push_back({.stageFlags = stage.pushConstants.stages,.offset = stage.pushConstants.offset,.size = stage.pushConstants.size,.reserved = 0});
+        }
+    }
+    std::vector<DescriptorSetRecord> descriptorSets;
+    std::vector<DescriptorRecord> descriptors;
+    std::vector<StringRef> descriptorNames;
+    std::vector<UniformBufferRecord> uniformBuffers;
+    std::vector<UniformMemberRecord> uniformMembers;
+    std::vector<DescriptorLayoutRecord> descriptorLayouts;
+    auto setStages = LayoutTableWriter::descriptorSetStages(fileData);
+    for (auto& descriptorSet: fileData.descriptorSets)
+    {
+        auto stageFlags = setStages[descriptorLayouts.size()];
+        descriptorLayouts.push_back({.id = LayoutTableWriter::layoutId(LayoutTableWriter::bindings(descriptorSet,stageFlags)),.stageFlags = stageFlags,.reserved = 0});
+        descriptorSets.push_back({.set = (uint32_t)descriptorSet.index(),.firstDescriptor = (uint32_t)(sharedLayouts ? descriptorNames.size() : descriptors.size()),
+                                  .descriptorCount = (uint32_t)descriptorSet.descriptorCount(),.reserved = 0});
+        std::vector<size_t> order(descriptorSet.descriptorCount());
+        std::iota(order.begin(),order.end(),0);
+        if (sharedLayouts)
+        {
+            //names pair up with the bindings of the set's layout in the table, which are sorted by binding
+            std::stable_sort(order.begin(),order.end(),[&](size_t a, size_t b){return descriptorSet.at(a).index < descriptorSet.at(b).index;});
+        }
+        for (auto i: order)
+        {
+            auto& descriptor = descriptorSet.at(i);
+            if (descriptor.size > 0)
+            {
+                uniformBuffers.push_back({.descriptor = (uint32_t)(sharedLayouts ? descriptorNames.size() : descriptors.size()),.size = (uint32_t)descriptor.size,.firstMember = (uint32_t)uniformMembers.size(),.memberCount = (uint32_t)descriptor.members.size()});
+                for (auto& member: descriptor.members)
+                {
+                    uniformMembers.push_back({.nameHash = uniformNameHash(member.name),.name = intern(member.name),.offset = member.offset,.size = member.size,.type = member.type,
+                                              .rows = member.rows,.columns = member.columns,.arrayCount = member.arrayCount,.arrayStride = member.arrayStride});
+                }
+            }
+            if (sharedLayouts)
+            {
+                descriptorNames.push_back(intern(descriptor.name));
+            }
+            else
+            {
+                descriptors.push_back({.name = intern(descriptor.name),.binding = (uint32_t)descriptor.index,.type = (uint32_t)descriptor.type,.count = (uint32_t)descriptor.count,.reserved = 0});
+            }
+        }
+    }
+
+    std::vector<VariantAxisRecord> variantAxes;
+    std::vector<StringRef> variantValues;
+    std::vector<VariantRecord> variants;
+    if (!fileData.variants.empty())
+    {
+        uint32_t keyBits = 0;
+        for (auto& axis: fileData.variantAxes)
+        {
+            variantAxes.push_back({.name = intern(axis.name),.shift = axis.shift,.bits = axis.bits,.firstValue = (uint32_t)variantValues.size(),.valueCount = (uint32_t)axis.values.size()});
+            for (auto& value: axis.values)
+            {
+                variantValues.push_back(intern(value));
+            }
+            keyBits = std::max(keyBits,axis.shift + axis.bits);
+        }
+        //indexed by key so loaders find a variant without searching
+        variants.resize((size_t)1 << keyBits,VariantRecord{});
+        for (auto& variant: fileData.variants)
+        {
+            variants[variant.key] = {.firstStage = variant.firstStage,.stageCount = variant.stageCount,.firstDescriptorSet = variant.firstDescriptorSet,.descriptorSetCount = variant.descriptorSetCount};
+        }
+    }
+
+    std::vector<SectionHeader> sections = {
+        {.type = SECTION_STAGES,.count = (uint32_t)stages.size(),.offset = 0,.size = stages.size()*sizeof(StageRecord)},
+        {.type = SECTION_PARAMETERS,.count = (uint32_t)parameters.size(),.offset = 0,.size = parameters.size()*sizeof(StringRef)},
+        {.type = SECTION_DESCRIPTOR_SETS,.count = (uint32_t)descriptorSets.size(),.offset = 0,.size = descriptorSets.size()*sizeof(DescriptorSetRecord)},
+        sharedLayouts ? SectionHeader{.type = SECTION_DESCRIPTOR_NAMES,.count = (uint32_t)descriptorNames.size(),.offset = 0,.size = descriptorNames.size()*sizeof(StringRef)}
+                      : SectionHeader{.type = SECTION_DESCRIPTORS,.count = (uint32_t)descriptors.size(),.offset = 0,.size = descriptors.size()*sizeof(DescriptorRecord)},
+        {.type = SECTION_BLOBS,.count = (uint32_t)blobs.size(),.offset = 0,.size = blobs.size()*sizeof(BlobRecord)},
+        {.type = SECTION_BLOB_IDS,.count = (uint32_t)blobIds.size(),.offset = 0,.size = blobIds.size()*sizeof(uint64_t)},
+        {.type = SECTION_STRINGS,.count = (uint32_t)strings.size(),.offset = 0,.size = strings.size()},
+    };
+    if (!entryPoints.empty())
+    {
+        sections.insert(sections.end() - 1,{.type = SECTION_ENTRY_POINTS,.count = (uint32_t)entryPoints.size(),.offset = 0,.size = entryPoints.size()*sizeof(StringRef)});
+    }
+    if (!targetCode.empty())
+    {
+        sections.insert(sections.end() - 1,{.type = SECTION_TARGET_CODE,.count = (uint32_t)targetCode.size(),.offset = 0,.size = targetCode.size()*sizeof(TargetCodeRecord)});
+    }
+    if (!variants.empty())
+    {
+        sections.insert(sections.end() - 1,{
+            {.type = SECTION_VARIANT_AXES,.count = (uint32_t)variantAxes.size(),.offset = 0,.size = variantAxes.size()*sizeof(VariantAxisRecord)},
+            {.type = SECTION_VARIANT_VALUES,.count = (uint32_t)variantValues.size(),.offset = 0,.size = variantValues.size()*sizeof(StringRef)},
+            {.type = SECTION_VARIANTS,.count = (uint32_t)variants.size(),.offset = 0,.size = variants.size()*sizeof(VariantRecord)}
+        });
+    }
+    if (!pushConstants.empty())
+    {
+        sections.insert(sections.end() - 1,{.type = SECTION_PUSH_CONSTANTS,.count = (uint32_t)pushConstants.size(),.offset = 0,.size = pushConstants.size()*sizeof(PushConstantRecord)});
+    }
+    if (!descriptorLayouts.empty())
+    {
+        sections.insert(sections.end() - 1,{.type = SECTION_DESCRIPTOR_LAYOUTS,.count = (uint32_t)descriptorLayouts.size(),.offset = 0,.size = descriptorLayouts.size()*sizeof(DescriptorLayoutRecord)});
+    }
+    if (!uniformBuffers.empty())
+    {
+        sections.insert(sections.end() - 1,{
+            {.type = SECTION_UNIFORM_BUFFERS,.count = (uint32_t)uniformBuffers.size(),.offset = 0,.size = uniformBuffers.size()*sizeof(UniformBufferRecord)},
+            {.type = SECTION_UNIFORM_MEMBERS,.count = (uint32_t)uniformMembers.size(),.offset = 0,.size = uniformMembers.size()*sizeof(UniformMemberRecord)}
+        });
+    }
+
+    //lay the whole file out first so the metadata is allocated once and every offset is known before anything is appended
+    size_t offset = sizeof(FileHeader) + sections.size()*sizeof(SectionHeader);
+    for (auto& section: sections)
+    {
+        offset = alignUp(offset,CSHDR_SECTION_ALIGNMENT);
+        section.offset = offset;
+        offset += section.size;
+    }
+    size_t metadataSize = offset;
+    for (auto& blob: blobs)
+    {
+        auto aligned = alignUp(offset,CSHDR_BLOB_ALIGNMENT);
+        metadataSize += aligned - offset;
+        blob.offset = aligned;
+        offset = aligned + blob.size;
+    }
+    reserveMetadata(metadataSize);
+
+    appendMetadata(CSHDR_V2_MAGIC,sizeof(CSHDR_V2_MAGIC));
+    appendValue<uint32_t>(CSHDR_VERSION);
+    appendValue<uint32_t>(sizeof(FileHeader));
+    appendValue<uint64_t>(offset);
+    appendValue<uint32_t>(sections.size());
+    appendValue<uint32_t>(sharedLayouts ? FILE_FLAG_SHARED_LAYOUTS : 0);
+    for (auto& section: sections)
+    {
+        appendValue<uint32_t>(section.type);
+        appendValue<uint32_t>(section.count);
+        appendValue<uint64_t>(section.offset);
+        appendValue<uint64_t>(section.size);
+    }
+    auto appendString = [&](const StringRef& reference)
+    {
+        appendValue<uint32_t>(reference.offset);
+        appendValue<uint32_t>(reference.size);
+    };
+    appendPadding(CSHDR_SECTION_ALIGNMENT);
+    for (auto& stage: stages)
+    {
+        appendString(stage.stage);
+        appendValue<uint32_t>(stage.firstParameter);
+        appendValue<uint32_t>(stage.parameterCount);
+        appendValue<uint32_t>(stage.blob);
+        appendValue<uint32_t>(stage.reserved);
+    }
+    appendPadding(CSHDR_SECTION_ALIGNMENT);
+    for (auto& parameter: parameters)
+    {
+        appendString(parameter);
+    }
+    appendPadding(CSHDR_SECTION_ALIGNMENT);
+    for (auto& descriptorSet: descriptorSets)
+    {
+        appendValue<uint32_t>(descriptorSet.set);
+        appendValue<uint32_t>(descriptorSet.firstDescriptor);
+        appendValue<uint32_t>(descriptorSet.descriptorCount);
+        appendValue<uint32_t>(descriptorSet.reserved);
+    }
+    appendPadding(CSHDR_SECTION_ALIGNMENT);
+    for (auto& name: descriptorNames)
+    {
+        appendString(name);
+    }
+    for (auto& descriptor: descriptors)
+    {
+        appendString(descriptor.name);
+        appendValue<uint32_t>(descriptor.binding);
+        appendValue<uint32_t>(descriptor.type);
+        appendValue<uint32_t>(descriptor.count);
+        appendValue<uint32_t>(descriptor.reserved);
+    }
+    appendPadding(CSHDR_SECTION_ALIGNMENT);
+    for (auto& blob: blobs)
+    {
+        appendValue<uint64_t>(blob.offset);
+        appendValue<uint32_t>(blob.size);
+        appendValue<uint32_t>(blob.encoding);
+    }
+    appendPadding(CSHDR_SECTION_ALIGNMENT);
+    for (auto blobId: blobIds)
+    {
+        appendValue<uint64_t>(blobId);
+    }
+    if (!entryPoints.empty())
+    {
+        appendPadding(CSHDR_SECTION_ALIGNMENT);
+        for (auto& entryPoint: entryPoints)
+        {
+            appendString(entryPoint);
+        }
+    }
+    if (!targetCode.empty())
+    {
+        appendPadding(CSHDR_SECTION_ALIGNMENT);
+        for (auto& code: targetCode)
+        {
+            appendValue<uint32_t>(code.stage);
+            appendValue<uint32_t>(code.target);
+            appendValue<uint32_t>(code.blob);
+            appendValue<uint32_t>(code.reserved);
+        }
+    }
+    if (!variants.empty())
+    {
+        appendPadding(CSHDR_SECTION_ALIGNMENT);
+        for (auto& axis: variantAxes)
+        {
+            appendString(axis.name);
+            appendValue<uint32_t>(axis.shift);
+            appendValue<uint32_t>(axis.bits);
+            appendValue<uint32_t>(axis.firstValue);
+            appendValue<uint32_t>(axis.valueCount);
+        }
+        appendPadding(CSHDR_SECTION_ALIGNMENT);
+        for (auto& value: variantValues)
+        {
+            appendString(value);
+        }
+        appendPadding(CSHDR_SECTION_ALIGNMENT);
+        for (auto& variant: variants)
+        {
+            appendValue<uint32_t>(variant.firstStage);
+            appendValue<uint32_t>(variant.stageCount);
+            appendValue<uint32_t>(variant.firstDescriptorSet);
+            appendValue<uint32_t>(variant.descriptorSetCount);
+        }
+    }
+    if (!pushConstants.empty())
+    {
+        appendPadding(CSHDR_SECTION_ALIGNMENT);
+        for (auto& range: pushConstants)
+        {
+            appendValue<uint32_t>(range.stageFlags);
+            appendValue<uint32_t>(range.offset);
+            appendValue<uint32_t>(range.size);
+            appendValue<uint32_t>(range.reserved);
+        }
+    }
+    if (!descriptorLayouts.empty())
+    {
+        appendPadding(CSHDR_SECTION_ALIGNMENT);
+        for (auto& layout: descriptorLayouts)
+        {
+            appendValue<uint64_t>(layout.id);
+            appendValue<uint32_t>(layout.stageFlags);
+            appendValue<uint32_t>(layout.reserved);
+        }
+    }
+    if (!uniformBuffers.empty())
+    {
+        appendPadding(CSHDR_SECTION_ALIGNMENT);
+        for (auto& buffer: uniformBuffers)
+        {
+            appendValue<uint32_t>(buffer.descriptor);
+            appendValue<uint32_t>(buffer.size);
+            appendValue<uint32_t>(buffer.firstMember);
+            appendValue<uint32_t>(buffer.memberCount);
+        }
+        appendPadding(CSHDR_SECTION_ALIGNMENT);
+        for (auto& member: uniformMembers)
+        {
+            appendValue<uint64_t>(member.nameHash);
+            appendString(member.name);
+            appendValue<uint32_t>(member.offset);
+            appendValue<uint32_t>(member.size);
+            appendValue<uint32_t>(member.type);
+            appendValue<uint16_t>(member.rows);
+            appendValue<uint16_t>(member.columns);
+            appendValue<uint32_t>(member.arrayCount);
+            appendValue<uint32_t>(member.arrayStride);
+        }
+    }
+    appendPadding(CSHDR_SECTION_ALIGNMENT);
+    appendMetadata(strings.data(),strings.size());
+    for (auto i=0; i<blobs.size(); ++i)
+    {
+        appendPadding(CSHDR_BLOB_ALIGNMENT);
+        appendData(blobData[i],blobs[i].size);
+    }
+}
+
+size_t ShaderFileWriter::duplicateBytes()
+{
+    return _duplicateBytes;
+}
@@ -0,0 +1,36 @@
+#ifndef SHADERFAX_SHADERFILEWRITER_H
+#define SHADERFAX_SHADERFILEWRITER_H
+#include <vector>
+
+#include <shaderfax/CshdrFormat.h>
+
+#include "GatherWriter.h"
+#include "ShaderFileData.h"
+
+enum class ShaderFileFormat
+{
+  ///Sequential text headers followed by each stage's code, must be parsed front to back
+  V1,
+  ///Indexed sections and aligned code that can be used in place from a mapped file, see shaderfax/CshdrFormat.h
+  V2
+};
+
+///Serializes a .cshdr file. Header and descriptor metadata are built in one buffer of exactly the right size, compiled code is
+///written straight out of the Slang blobs without being copied
+class ShaderFileWriter : public GatherWriter
+{
+private:
+  ///Compressed copies of code, the only code the writer owns
+  std::vector<std::vector<char>> _encodedBlobs;
+  size_t _duplicateBytes = 0;
+  void serializeV1(ShaderFileData& fileData);
+  void serializeV2(ShaderFileData& fileData, shaderfax::BlobEncoding encoding, bool sharedLayouts);
+public:
+  ///Code is only encoded in v2 files, v1 has nowhere to record an encoding. v2 files sharing layouts only name their
+  ///descriptors and leave the rest to the build's layout table
+  ShaderFileWriter(ShaderFileData& fileData, ShaderFileFormat format = ShaderFileFormat::V1, shaderfax::BlobEncoding encoding = shaderfax::BLOB_ENCODING_NONE, bool sharedLayouts = false);
+  ///Bytes of code not written because another stage of the file has identical code, always zero for v1
+  size_t duplicateBytes();
+};
+
+#endif //SHADERFAX_SHADERFILEWRITER_H
@@ -0,0 +1,224 @@
+#include "ShaderPackWriter.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <unordered_map>
+
+#include <shaderfax/PackFormat.h>
+
+#include "Hash.h"
+
+using namespace shaderfax;
+
+///Code shared by the pack
+struct PackBlob
+{
+    const std::byte* data;
+    uint32_t size;
+    uint32_t encoding;
+    uint64_t offset;
+};
+
+bool ShaderPackWriter::addFile(const std::string& path, const std::filesystem::path& file)
+{
+    PackFile packFile{.path = path,.mapping = std::make_shared<MappedFile>()};
+    if (!packFile.mapping->open(file) || !packFile.view.parse(packFile.mapping->data()))
+    {
+        return false;
+    }
+    packFile.data = packFile.mapping->data();
+    _files.push_back(std::move(packFile));
+    return true;
+}
+
+bool ShaderPackWriter::addPack(const std::filesystem::path& pack)
+{
+    auto mapping = std::make_shared<MappedFile>();
+    ShaderPackView packView;
+    if (!mapping->open(pack) || !packView.parse(mapping->data()))
+    {
+        return false;
+    }
+    for (auto i=0; i<packView.size(); ++i)
+    {
+        PackFile packFile{.path = std::string(packView.path(i)),.mapping = mapping,.data = packView.data(i)};
+        if (!packView.file(i,packFile.view))
+        {
+            return false;
+        }
+        _files.push_back(std::move(packFile));
+    }
+    return true;
+}
+
+void ShaderPackWriter::finish()
+{
+    uint32_t bucketCount = std::bit_ceil(std::max<size_t>(1,_files.size()));
+    auto bucketOf = [&](const PackFile& file){return packHash(file.path) & (bucketCount - 1);};
+    std::sort(_files.begin(),_files.end(),[&](const PackFile& a, const PackFile& b)
+    {
+        auto bucketA = bucketOf(a);
+        auto bucketB = bucketOf(b);
+        return bucketA != bucketB ? bucketA < bucketB : a.path < b.path;
+    });
+
+    //collect the distinct code of every v2 file, v1 files keep their code inline
+    std::vector<PackBlob> packBlobs;
+    std::unordered_multimap<uint64_t,uint32_t> packBlobIndices;
+    std::vector<std::vector<uint32_t>> fileBlobs(_files.size());
+    for (auto i=0; i<_files.size(); ++i)
+    {
+        auto& view = _files[i].view;
+        auto blobs = view.blobs();
+        auto blobIds = view.blobIds();
+        for (auto j=0; j<blobs.size(); ++j)
+        {
+            PackBlob blob{.data = view.blobData(j).data(),.size = blobs[j].size,.encoding = blobs[j].encoding,.offset = 0};
+            auto key = hashCombine(blobIds.empty() ? hashBytes(blob.data,blob.size) : blobIds[j],blob.encoding);
+            ++_blobCount;
+
+            uint32_t index = packBlobs.size();
+            auto [begin,end] = packBlobIndices.equal_range(key);
+            for (auto existing = begin; existing != end; ++existing)
+            {
+                auto& candidate = packBlobs[existing->second];
+                if (candidate.size == blob.size && candidate.encoding == blob.encoding && std::memcmp(candidate.data,blob.data,blob.size) == 0)
+                {
+                    index = existing->second;
+                    _duplicateBytes += blob.size;
+                    break;
+                }
+            }
+            if (index == packBlobs.size())
+            {
+                packBlobs.push_back(blob);
+                packBlobIndices.emplace(key,index);
+            }
+            fileBlobs[i].push_back(index);
+        }
+    }
+    _uniqueBlobCount = packBlobs.size();
+
+    std::vector<uint32_t> buckets(bucketCount + 1,0);
+    std::vector<PackEntry> entries;
+    std::vector<char> strings;
+    for (auto& file: _files)
+    {
+        ++buckets[bucketOf(file) + 1];
+        entries.push_back({
+            .hash = packHash(file.path),
+            .path = {.offset = (uint32_t)strings.size(),.size = (uint32_t)file.path.size()},
+            .offset = 0,
+            .size = file.view.version() == 2 ? file.view.metadataSize() : file.data.size()
+        });
+        strings.insert(strings.end(),file.path.c_str(),file.path.c_str() + file.path.size() + 1);
+    }
+    for (auto i=0; i<bucketCount; ++i)
+    {
+        buckets[i + 1] += buckets[i];
+    }
+
+    size_t bucketsOffset = sizeof(PackHeader);
+    size_t entriesOffset = alignUp(bucketsOffset + buckets.size()*sizeof(uint32_t),alignof(PackEntry));
+    size_t stringsOffset = entriesOffset + entries.size()*sizeof(PackEntry);
+    size_t offset = stringsOffset + strings.size();
+    size_t metadataSize = offset;
+    for (auto& entry: entries)
+    {
+        auto aligned = alignUp(offset,PACK_FILE_ALIGNMENT);
+        metadataSize += aligned - offset;
+        entry.offset = aligned;
+        offset = aligned + entry.size;
+    }
+    for (auto& blob: packBlobs)
+    {
+        auto aligned = alignUp(offset,CSHDR_BLOB_ALIGNMENT);
+        metadataSize += aligned - offset;
+        blob.offset = aligned;
+        offset = aligned + blob.size;
+    }
+    reserveMetadata(metadataSize);
+
+    //point the blob records of every v2 file at the shared code
+    for (auto i=0; i<_files.size(); ++i)
+    {
+        auto& file = _files[i];
+        if (file.view.version() != 2)
+        {
+            continue;
+        }
+        auto data = (const char*)file.data.data();
+        file.metadata.assign(data,data + file.view.metadataSize());
+        auto patch = [&](size_t position, auto value)
+        {
+            boost::endian::native_to_little_inplace(value);
+            std::memcpy(file.metadata.data() + position,&value,sizeof(value));
+        };
+        patch(offsetof(FileHeader,fileSize),(uint64_t)file.metadata.size());
+        patch(offsetof(FileHeader,flags),(uint32_t)(((const FileHeader*)data)->flags | FILE_FLAG_PACKED_BLOBS));
+        auto records = (const char*)file.view.blobs().data() - data;
+        for (auto j=0; j<fileBlobs[i].size(); ++j)
+        {
+            patch(records + j*sizeof(BlobRecord) + offsetof(BlobRecord,offset),packBlobs[fileBlobs[i][j]].offset);
+        }
+    }
+
+    appendMetadata(PACK_MAGIC,sizeof(PACK_MAGIC));
+    appendValue<uint32_t>(PACK_VERSION);
+    appendValue<uint32_t>(sizeof(PackHeader));
+    appendValue<uint64_t>(offset);
+    appendValue<uint32_t>(entries.size());
+    appendValue<uint32_t>(bucketCount);
+    appendValue<uint64_t>(bucketsOffset);
+    appendValue<uint64_t>(entriesOffset);
+    appendValue<uint64_t>(stringsOffset);
+    appendValue<uint64_t>(strings.size());
+    for (auto bucket: buckets)
+    {
+        appendValue<uint32_t>(bucket);
+    }
+    appendPadding(alignof(PackEntry));
+    for (auto& entry: entries)
+    {
+        appendValue<uint64_t>(entry.hash);
+        appendValue<uint32_t>(entry.path.offset);
+        appendValue<uint32_t>(entry.path.size);
+        appendValue<uint64_t>(entry.offset);
+        appendValue<uint64_t>(entry.size);
+    }
+    appendMetadata(strings.data(),strings.size());
+    for (auto& file: _files)
+    {
+        appendPadding(PACK_FILE_ALIGNMENT);
+        if (file.view.version() == 2)
+        {
+            appendData(file.metadata.data(),file.metadata.size());
+        }
+        else
+        {
+            appendData(file.data.data(),file.data.size());
+        }
+    }
+    for (auto& blob: packBlobs)
+    {
+        appendPadding(CSHDR_BLOB_ALIGNMENT);
+        appendData(blob.data,blob.size);
+    }
+}
+
+size_t ShaderPackWriter::blobCount()
+{
+    return _blobCount;
+}
+
+size_t ShaderPackWriter::uniqueBlobCount()
+{
+    return _uniqueBlobCount;
+}
+
+size_t ShaderPackWriter::duplicateBytes()
+{
+    return _duplicateBytes;
+}
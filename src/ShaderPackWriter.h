@@ -0,0 +1,46 @@
+#ifndef SHADERFAX_SHADERPACKWRITER_H
+#define SHADERFAX_SHADERPACKWRITER_H
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <shaderfax/Reader.h>
+
+#include "GatherWriter.h"
+
+///Serializes a .shpak archive of .cshdr files, see shaderfax/PackFormat.h. Files are mapped and written straight from the
+///mapping. Code of v2 files is moved into a region shared by the whole pack, where identical blobs are stored once
+class ShaderPackWriter : public GatherWriter
+{
+private:
+  struct PackFile
+  {
+    std::string path;
+    ///Mapping of the .cshdr file, or of the .shpak it was taken from, which all of the pack's files share
+    std::shared_ptr<shaderfax::MappedFile> mapping;
+    ///Bytes of the file inside the mapping
+    std::span<const std::byte> data;
+    shaderfax::ShaderFileView view;
+    ///Copy of a v2 file's header and sections with its blob offsets pointing into the pack
+    std::vector<char> metadata;
+  };
+  std::vector<PackFile> _files;
+  size_t _blobCount = 0;
+  size_t _uniqueBlobCount = 0;
+  size_t _duplicateBytes = 0;
+public:
+  ///Adds a .cshdr file under its path relative to the output folder, fails if it can't be read or isn't a valid file
+  bool addFile(const std::string& path, const std::filesystem::path& file);
+  ///Adds every file of another pack under its path in that pack, fails if the pack or any file in it isn't valid
+  bool addPack(const std::filesystem::path& pack);
+  ///Lays out the index and contents, call once after every file was added
+  void finish();
+  ///Blobs of all v2 files in the pack
+  size_t blobCount();
+  size_t uniqueBlobCount();
+  ///Bytes of code not written because another file in the pack has identical code
+  size_t duplicateBytes();
+};
+
+#endif //SHADERFAX_SHADERPACKWRITER_H
@@ -0,0 +1,137 @@
+#include "SpirvStrip.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string_view>
+#include <utility>
+
+#include <shaderfax/SpirvCodec.h>
+
+#include "MemoryBlob.h"
+
+enum Opcode : uint32_t
+{
+    OP_SOURCE_CONTINUED = 2,
+    OP_SOURCE = 3,
+    OP_SOURCE_EXTENSION = 4,
+    OP_NAME = 5,
+    OP_MEMBER_NAME = 6,
+    OP_STRING = 7,
+    OP_LINE = 8,
+    OP_EXTENSION = 10,
+    OP_EXT_INST_IMPORT = 11,
+    OP_EXT_INST = 12,
+    OP_NO_LINE = 317,
+    OP_MODULE_PROCESSED = 330
+};
+
+///Literal string operand starting at words[0], NUL terminated and padded to a whole word
+std::string_view literalString(std::span<const uint32_t> words);
+
+bool stripDebugInfo(std::span<const uint32_t> words, std::vector<uint32_t>& stripped)
+{
+    using namespace shaderfax::spirv;
+    stripped.clear();
+    if (words.size() < HEADER_WORDS || words[0] != MAGIC)
+    {
+        return false;
+    }
+
+    //extended instruction sets have to be known before the instructions using them, which follow them in the module
+    std::vector<uint32_t> nonSemanticSets;
+    for (size_t position = HEADER_WORDS; position < words.size();)
+    {
+        uint32_t opcode = words[position] & 0xffff;
+        uint32_t wordCount = words[position] >> 16;
+        if (wordCount == 0 || wordCount > words.size() - position)
+        {
+            return false;
+        }
+        if (opcode == OP_EXT_INST_IMPORT && wordCount >= 3 && literalString(words.subspan(position + 2,wordCount - 2)).starts_with("NonSemantic."))
+        {
+            nonSemanticSets.push_back(words[position + 1]);
+        }
+        position += wordCount;
+    }
+
+    stripped.reserve(words.size());
+    stripped.insert(stripped.end(),words.begin(),words.begin() + HEADER_WORDS);
+    for (size_t position = HEADER_WORDS; position < words.size();)
+    {
+        uint32_t opcode = words[position] & 0xffff;
+        uint32_t wordCount = words[position] >> 16;
+        auto instruction = words.subspan(position,wordCount);
+        position += wordCount;
+
+        bool debug = false;
+        switch (opcode)
+        {
+            case OP_SOURCE_CONTINUED:
+            case OP_SOURCE:
+            case OP_SOURCE_EXTENSION:
+            case OP_NAME:
+            case OP_MEMBER_NAME:
+            case OP_STRING:
+            case OP_LINE:
+            case OP_NO_LINE:
+            case OP_MODULE_PROCESSED:
+                debug = true;
+                break;
+            case OP_EXTENSION:
+                debug = !nonSemanticSets.empty() && wordCount >= 2 && literalString(instruction.subspan(1)) == "SPV_KHR_non_semantic_info";
+                break;
+            case OP_EXT_INST_IMPORT:
+                debug = wordCount >= 2 && std::find(nonSemanticSets.begin(),nonSemanticSets.end(),instruction[1]) != nonSemanticSets.end();
+                break;
+            case OP_EXT_INST:
+                debug = wordCount >= 4 && std::find(nonSemanticSets.begin(),nonSemanticSets.end(),instruction[3]) != nonSemanticSets.end();
+                break;
+        }
+        if (!debug)
+        {
+            stripped.insert(stripped.end(),instruction.begin(),instruction.end());
+        }
+    }
+    return true;
+}
+
+std::string_view literalString(std::span<const uint32_t> words)
+{
+    auto characters = reinterpret_cast<const char*>(words.data());
+    auto size = words.size()*sizeof(uint32_t);
+    return std::string_view(characters,std::find(characters,characters + size,'\0'));
+}
+
+void stripStageCode(ShaderOutData& outData)
+{
+    auto size = outData.spirvCode->getBufferSize();
+    auto words = std::span(static_cast<const uint32_t*>(outData.spirvCode->getBufferPointer()),size/sizeof(uint32_t));
+    std::vector<uint32_t> stripped;
+    if (size % sizeof(uint32_t) == 0 && stripDebugInfo(words,stripped) && stripped.size() < words.size())
+    {
+        std::vector<char> code(stripped.size()*sizeof(uint32_t));
+        std::memcpy(code.data(),stripped.data(),code.size());
+        outData.spirvCode = MemoryBlob::create(std::move(code));
+    }
+}
+
+void stripFileCode(ShaderFileData& fileData)
+{
+    //the original blobs are held by the map, so their addresses can't be reused by a stripped copy while it is in use
+    std::map<slang::IBlob*,std::pair<Slang::ComPtr<slang::IBlob>,Slang::ComPtr<slang::IBlob>>> strippedBlobs;
+    for (auto& outData: fileData.shaderOutData)
+    {
+        auto [stripped,added] = strippedBlobs.try_emplace(outData.spirvCode.get());
+        if (added)
+        {
+            stripped->second.first = outData.spirvCode;
+            stripStageCode(outData);
+            stripped->second.second = outData.spirvCode;
+        }
+        else
+        {
+            outData.spirvCode = stripped->second.second;
+        }
+    }
+}
@@ -0,0 +1,19 @@
+#ifndef SHADERFAX_SPIRVSTRIP_H
+#define SHADERFAX_SPIRVSTRIP_H
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "ShaderFileData.h"
+
+///Copies a SPIR-V module without the instructions that only serve debuggers: sources, names, strings, line information,
+///processing notes and every NonSemantic extended instruction set. None of them affect execution, so the result behaves
+///identically. Returns false if the words aren't a well formed module
+bool stripDebugInfo(std::span<const uint32_t> words, std::vector<uint32_t>& stripped);
+///Replaces the SPIR-V of a stage with a stripped copy, code that isn't SPIR-V or has nothing to strip is kept as it is
+void stripStageCode(ShaderOutData& outData);
+///Strips the SPIR-V of every stage of a file. Stages sharing a blob, like the stages of a shared module, keep sharing the
+///stripped copy, so every distinct blob is stripped once
+void stripFileCode(ShaderFileData& fileData);
+
+#endif //SHADERFAX_SPIRVSTRIP_H
@@ -0,0 +1,234 @@
+#include "VariantMatrix.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+constexpr std::string_view DIRECTIVE = "shaderfax variants:";
+
+std::string_view trim(std::string_view text);
+bool isSameCode(slang::IBlob* a, slang::IBlob* b);
+bool isSameStage(const ShaderOutData& a, const ShaderOutData& b);
+bool isSameDescriptorSet(DescriptorSet& a, DescriptorSet& b);
+
+bool VariantMatrix::load(const std::filesystem::path& file, std::ostream& errors)
+{
+    _axes.clear();
+    std::ifstream inFile(file);
+    if (!inFile)
+    {
+        errors << "Unable to read "<<file<<"\n";
+        return false;
+    }
+    return read(inFile,file,errors);
+}
+
+bool VariantMatrix::read(std::istream& source, const std::filesystem::path& file, std::ostream& errors)
+{
+    _axes.clear();
+    std::string line;
+    while (std::getline(source,line))
+    {
+        auto text = trim(line);
+        if (!text.starts_with("//"))
+        {
+            continue;
+        }
+        text = trim(text.substr(2));
+        if (text.starts_with(DIRECTIVE) && !parseDeclaration(text.substr(DIRECTIVE.size())))
+        {
+            errors << file<<": invalid variant matrix \""<<text<<"\"\n";
+            _axes.clear();
+            return false;
+        }
+    }
+
+    uint32_t shift = 0;
+    for (auto& axis: _axes)
+    {
+        axis.shift = shift;
+        axis.bits = std::bit_width(axis.values.size() - 1);
+        shift += axis.bits;
+    }
+    if (shift > MAX_KEY_BITS)
+    {
+        errors << file<<": variant matrix needs "<<shift<<" key bits, at most "<<MAX_KEY_BITS<<" are supported\n";
+        _axes.clear();
+        return false;
+    }
+    return true;
+}
+
+bool VariantMatrix::parseDeclaration(std::string_view declaration)
+{
+    //NAME={value,...} axes, optionally separated by x
+    auto text = trim(declaration);
+    while (!text.empty())
+    {
+        auto equals = text.find('=');
+        auto open = text.find('{');
+        auto close = text.find('}');
+        if (equals == std::string_view::npos || open == std::string_view::npos || close == std::string_view::npos || equals > open || open > close)
+        {
+            return false;
+        }
+        VariantAxis axis{.name = std::string(trim(text.substr(0,equals)))};
+        if (axis.name.empty() || trim(text.substr(equals + 1,open - equals - 1)).size() != 0
+            || std::any_of(_axes.begin(),_axes.end(),[&](const VariantAxis& existing){return existing.name == axis.name;}))
+        {
+            return false;
+        }
+        auto values = text.substr(open + 1,close - open - 1);
+        while (true)
+        {
+            auto comma = values.find(',');
+            auto value = trim(values.substr(0,comma));
+            if (value.empty())
+            {
+                return false;
+            }
+            axis.values.emplace_back(value);
+            if (comma == std::string_view::npos)
+            {
+                break;
+            }
+            values.remove_prefix(comma + 1);
+        }
+        _axes.push_back(std::move(axis));
+
+        text = trim(text.substr(close + 1));
+        if (text.starts_with("x ") || text.starts_with("x\t"))
+        {
+            text = trim(text.substr(1));
+        }
+    }
+    return true;
+}
+
+bool VariantMatrix::empty() const
+{
+    return _axes.empty();
+}
+
+size_t VariantMatrix::combinationCount() const
+{
+    size_t count = 1;
+    for (auto& axis: _axes)
+    {
+        count *= axis.values.size();
+    }
+    return count;
+}
+
+void VariantMatrix::macros(size_t combination, std::vector<ShaderMacro>& macros) const
+{
+    macros.clear();
+    for (auto& axis: _axes)
+    {
+        macros.push_back({.name = axis.name,.value = axis.values[combination % axis.values.size()]});
+        combination /= axis.values.size();
+    }
+}
+
+uint32_t VariantMatrix::key(size_t combination) const
+{
+    uint32_t key = 0;
+    for (auto& axis: _axes)
+    {
+        key |= (uint32_t)(combination % axis.values.size()) << axis.shift;
+        combination /= axis.values.size();
+    }
+    return key;
+}
+
+size_t VariantMatrix::merge(std::vector<ShaderFileData>& combinations, ShaderFileData& fileData) const
+{
+    fileData = ShaderFileData();
+    fileData.variantAxes = _axes;
+    size_t distinct = 0;
+    for (size_t i=0; i<combinations.size(); ++i)
+    {
+        auto& combination = combinations[i];
+        ShaderVariant variant{.key = key(i)};
+        bool sharedStages = false;
+        bool sharedSets = false;
+        for (auto& previous: fileData.variants)
+        {
+            if (!sharedStages && previous.stageCount == combination.shaderOutData.size()
+                && std::equal(combination.shaderOutData.begin(),combination.shaderOutData.end(),fileData.shaderOutData.begin() + previous.firstStage,isSameStage))
+            {
+                variant.firstStage = previous.firstStage;
+                variant.stageCount = previous.stageCount;
+                sharedStages = true;
+            }
+            if (!sharedSets && previous.descriptorSetCount == combination.descriptorSets.size()
+                && std::equal(combination.descriptorSets.begin(),combination.descriptorSets.end(),fileData.descriptorSets.begin() + previous.firstDescriptorSet,isSameDescriptorSet))
+            {
+                variant.firstDescriptorSet = previous.firstDescriptorSet;
+                variant.descriptorSetCount = previous.descriptorSetCount;
+                sharedSets = true;
+            }
+        }
+        if (!sharedStages)
+        {
+            variant.firstStage = fileData.shaderOutData.size();
+            variant.stageCount = combination.shaderOutData.size();
+            std::move(combination.shaderOutData.begin(),combination.shaderOutData.end(),std::back_inserter(fileData.shaderOutData));
+            ++distinct;
+        }
+        if (!sharedSets)
+        {
+            variant.firstDescriptorSet = fileData.descriptorSets.size();
+            variant.descriptorSetCount = combination.descriptorSets.size();
+            std::move(combination.descriptorSets.begin(),combination.descriptorSets.end(),std::back_inserter(fileData.descriptorSets));
+        }
+        fileData.variants.push_back(variant);
+    }
+    return distinct;
+}
+
+std::string_view trim(std::string_view text)
+{
+    auto first = text.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos)
+    {
+        return {};
+    }
+    return text.substr(first,text.find_last_not_of(" \t\r") - first + 1);
+}
+
+bool isSameCode(slang::IBlob* a, slang::IBlob* b)
+{
+    auto size = a->getBufferSize();
+    return size == b->getBufferSize() && std::memcmp(a->getBufferPointer(),b->getBufferPointer(),size) == 0;
+}
+
+bool isSameStage(const ShaderOutData& a, const ShaderOutData& b)
+{
+    return a.stage == b.stage && a.entryPoint == b.entryPoint && a.parameters == b.parameters && a.pushConstants == b.pushConstants && isSameCode(a.spirvCode,b.spirvCode)
+        && std::equal(a.targetCode.begin(),a.targetCode.end(),b.targetCode.begin(),b.targetCode.end(),[](const TargetCode& first, const TargetCode& second)
+        {
+            return first.target == second.target && isSameCode(first.code,second.code);
+        });
+}
+
+bool isSameDescriptorSet(DescriptorSet& a, DescriptorSet& b)
+{
+    if (a.index() != b.index() || a.descriptorCount() != b.descriptorCount())
+    {
+        return false;
+    }
+    for (size_t i=0; i<a.descriptorCount(); ++i)
+    {
+        auto& first = a.at(i);
+        auto& second = b.at(i);
+        if (first.name != second.name || first.type != second.type || first.index != second.index || first.count != second.count
+            || first.size != second.size || first.members != second.members)
+        {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,47 @@
+#ifndef SHADERFAX_VARIANTMATRIX_H
+#define SHADERFAX_VARIANTMATRIX_H
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ShaderFileData.h"
+
+///Preprocessor macro defined for a whole session
+struct ShaderMacro
+{
+  std::string name;
+  std::string value;
+  bool operator==(const ShaderMacro&) const = default;
+};
+
+///Macros a module is compiled with in every combination of their values, declared in the module's source with a line like
+///  // shaderfax variants: SKINNED={0,1} x SHADOWS={0,1,2}
+///Each combination is compiled as a variant of the module, and the variants are written to a single file with a table
+///indexed by variant key, so loaders pick one without searching
+class VariantMatrix
+{
+private:
+  std::vector<VariantAxis> _axes;
+  bool parseDeclaration(std::string_view declaration);
+public:
+  ///Largest number of bits a variant key may have
+  static constexpr uint32_t MAX_KEY_BITS = 16;
+  ///Reads the matrix declared in a source file. Files without a declaration have no axes and a single combination
+  bool load(const std::filesystem::path& file, std::ostream& errors);
+  ///Reads the matrix declared in source text, file only names it in errors
+  bool read(std::istream& source, const std::filesystem::path& file, std::ostream& errors);
+  bool empty() const;
+  size_t combinationCount() const;
+  ///Macros defining the values of a combination, the first axis varies fastest
+  void macros(size_t combination, std::vector<ShaderMacro>& macros) const;
+  uint32_t key(size_t combination) const;
+  ///Moves the output of every combination into a single file. Combinations with identical output share their stages and
+  ///descriptor sets, returns how many distinct combinations there were
+  size_t merge(std::vector<ShaderFileData>& combinations, ShaderFileData& fileData) const;
+};
+
+#endif //SHADERFAX_VARIANTMATRIX_H
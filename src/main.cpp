@@ -1,80 +1,138 @@
-#include <codecvt>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <map>
+#include <memory>
 #include <ostream>
-#include <slang-com-ptr.h>
-#include <slang.h>
+#include <set>
+#include <span>
+#include <sstream>
+#include <string_view>
+#include <thread>
+#include <tuple>
 #include <vector>
 #include <boost/program_options.hpp>
-#include <boost/endian/conversion.hpp>
 
-#include "DescriptorSet.h"
-#include "Texel.h"
+#include "BuildManifest.h"
+#include "CompileServer.h"
+#include "DependencyGraph.h"
+#include "FileWatcher.h"
+#include "Hash.h"
+#include "LayoutTableWriter.h"
+#include "MemoryBlob.h"
+#include "OutputQueue.h"
+#include "Profiler.h"
+#include "ShaderCompiler.h"
+#include "ShaderFileWriter.h"
+#include "ShaderPackWriter.h"
+#include "SpirvStrip.h"
+#include "VariantMatrix.h"
 using namespace slang;
 namespace po = boost::program_options;
 
-enum attributeFlags: uint16_t
-{
-    POSITION3D=0b0000000000000001,
-    POSITION2D=0b0000000000000010,
-    NORMAL=0b0000000000000100,
-    UVCOORDS=0b0000000000001000,
-    VERTEXCOLOR=0b0000000000010000,
-    BONEWIEGHTS=0b0000000000100000
+///How long watch mode waits for further changes before rebuilding, so a burst of saves causes a single rebuild
+constexpr std::chrono::milliseconds WATCH_DEBOUNCE(30);
 
-};
-enum ShaderType
+///Result of compiling a single .slang file on a worker thread
+struct ModuleResult
 {
-    UNKNOWN=0,
-    GRAPHICS,
-    COMPUTE,
-    RAY
+    bool upToDate = false;
+    bool processed = false;
+    bool success = false;
+    bool hasEntryPoints = false;
+    ShaderFileData fileData;
+    std::vector<std::filesystem::path> dependencies;
+    std::string errors;
+    VariantMatrix matrix;
+    ///Result of every combination of the variant matrix, merged into this result once all of them are compiled
+    std::vector<ModuleResult> combinations;
+    size_t distinctVariants = 0;
 };
-enum GeometryPipelineType
+
+///Code size of a single stage before and after debug information was stripped
+struct StageSize
 {
-    NA,
-    VERTEX,
-    MESH
+    std::string file;
+    std::string stage;
+    size_t compiled = 0;
+    size_t shipped = 0;
 };
 
-
-bool getModules(std::vector<IModule*>& modules,std::filesystem::path& root,Slang::ComPtr<ISession>& session);
-bool isSameShaderType(ShaderType& existingType, ShaderType comparisonType, GeometryPipelineType& existingPipeline, GeometryPipelineType comparisonPipeline, const std::filesystem::path& currentFile);
-bool isValidColorTarget(const std::string& colorTarget);
-bool isValidDepthTarget(const std::string & depthTarget);
-
-std::vector<std::string> getVertexParameters(FunctionReflection* reflection);
-std::vector<std::string> getHullParameters(FunctionReflection* reflection);
-std::vector<std::string> getDomainParameters(FunctionReflection* reflection);
-std::vector<std::string> getGeometryParameters(FunctionReflection* reflection);
-bool getFragmentParameters(FunctionReflection* reflection, std::vector<std::string>& parameters, const std::filesystem::path& currentFile);
-std::vector<std::string> getComputeParameters(FunctionReflection* reflection);
-std::vector<std::string> getRayGenerationParameters(FunctionReflection* reflection);
-std::vector<std::string> getIntersectionParameters(FunctionReflection* reflection);
-std::vector<std::string> getAnyHitParameters(FunctionReflection* reflection);
-std::vector<std::string> getClosestHitParameters(FunctionReflection* reflection);
-std::vector<std::string> getMissParameters(FunctionReflection* reflection);
-std::vector<std::string> getCallableParameters(FunctionReflection* reflection);
-std::vector<std::string> getMeshParameters(FunctionReflection* reflection);
-std::vector<std::string> getAmplificationParameters(FunctionReflection* reflection);
-
-struct ShaderOutData
+///What the writer thread did during a build
+struct OutputStats
 {
-    std::string stage;
-    std::vector<std::string> parameters;
-    Slang::ComPtr<IBlob> spirvCode=nullptr;
+    bool failed = false;
+    size_t fileCount = 0;
+    size_t duplicateBytes = 0;
+    std::vector<StageSize> sizes;
+    ///Every file written, so a full build can remove outputs it didn't produce
+    std::set<std::filesystem::path> written;
+    ///Layouts of the files written, which only name their descriptors when the build writes a layout table
+    LayoutTableWriter layouts;
 };
 
-struct ShaderFileData
+///Everything that outlives a single build, so watch mode keeps Slang global sessions and file hashes warm between rebuilds
+struct BuildState
 {
-    std::vector<ShaderOutData> shaderOutData;
-    std::vector<DescriptorSet> descriptorSets;
+    std::filesystem::path root;
+    std::filesystem::path output;
+    unsigned int jobs = 1;
+    ///Bytes of compiled code waiting to be written before compile workers pause
+    size_t maxInFlight = 0;
+    ///Only modules whose path hashes to shardIndex modulo shardCount are built
+    unsigned int shardIndex = 0;
+    unsigned int shardCount = 1;
+    std::filesystem::path manifestFile;
+    ShaderFileFormat format = ShaderFileFormat::V1;
+    shaderfax::BlobEncoding encoding = shaderfax::BLOB_ENCODING_NONE;
+    CompileSettings settings;
+    ///Release builds ship code without names and line information
+    bool stripDebugInfo = false;
+    ///Keep the unstripped code in a .cshdr.dbg file next to every output
+    bool debugSidecar = false;
+    BuildManifest manifest{ShaderCompiler::optionsHash(settings)};
+    bool incremental = false;
+    std::unique_ptr<ShaderCache> cache;
+    std::string dependencyGraphFile;
+    std::filesystem::path packFile;
+    std::filesystem::path layoutTableFile;
+    bool report = false;
+    std::vector<std::unique_ptr<ShaderCompiler>> compilers;
+    size_t compiledCount = 0;
+    std::unique_ptr<Profiler> profiler;
+    std::filesystem::path profileFile;
+    ///Number of slowest modules printed with the phase summary, zero prints no summary
+    size_t profileSummary = 0;
 };
 
-void removeFilesOfType(const std::filesystem::path& dir, const std::string& extension) {
+int build(BuildState& state);
+int merge(int argc, char** argv);
+void reportProfile(BuildState& state);
+bool writePack(BuildState& state);
+bool writeLayoutTable(BuildState& state, LayoutTableWriter& table);
+bool addToLayoutTable(LayoutTableWriter& table, const shaderfax::ShaderFileView& file, const std::filesystem::path& path);
+int watch(BuildState& state);
+void getModulePaths(std::vector<std::filesystem::path>& modulePaths,std::filesystem::path& root);
+void compileModules(const std::vector<std::filesystem::path>& modulePaths,BuildState& state,std::vector<ModuleResult>& results,OutputQueue& queue);
+void mergeCombinations(ModuleResult& result);
+void writeOutputs(BuildState& state,OutputQueue& queue,OutputStats& stats);
+bool writeOutput(BuildState& state,PendingOutput& pending,OutputStats& stats);
+std::filesystem::path outputPathFor(const std::filesystem::path& modulePath);
+std::filesystem::path debugPathFor(const std::filesystem::path& outputPath);
+void stripShaderCode(ShaderFileData& fileData, const std::string& file, std::vector<StageSize>& sizes);
+void printSizeTable(std::vector<StageSize>& sizes);
+
+void removeFilesOfType(const std::filesystem::path& dir, const std::string& extension, const std::set<std::filesystem::path>& keep) {
+    if (!std::filesystem::exists(dir)) {
+        return;
+    }
     for (const auto& entry : std::filesystem::recursive_directory_iterator(dir)) {
-        if (entry.is_regular_file() && entry.path().extension() == extension) {
+        if (entry.is_regular_file() && entry.path().extension() == extension && !keep.contains(entry.path().lexically_normal())) {
             try {
                 std::filesystem::remove(entry.path());
             } catch (const std::filesystem::filesystem_error& e) {
@@ -86,11 +144,43 @@ void removeFilesOfType(const std::filesystem::path& dir, const std::string& exte
 
 int main(int argc, char**argv)
 {
+    if (argc > 1 && std::string_view(argv[1]) == "merge")
+    {
+        return merge(argc - 1,argv + 1);
+    }
+    //shaderfax serve takes the build options, its files are compiled like a build with them would compile them
+    bool serving = argc > 1 && std::string_view(argv[1]) == "serve";
+    if (serving)
+    {
+        --argc;
+        ++argv;
+    }
     po::options_description desc("Allowed options");
     desc.add_options()
     ("help,h", "produce help message")
     ("root,r", po::value<std::string>(),"Top level folder containing shader files")
     ("output,o", po::value<std::string>()->default_value("output"),"Output folder for compiled files")
+    ("jobs,j", po::value<unsigned int>()->default_value(1),"Number of modules compiled in parallel, 0 uses every available core")
+    ("max-in-flight", po::value<size_t>()->default_value(256),"Megabytes of compiled code waiting to be written before compilation pauses")
+    ("rebuild", "Ignore the build manifest and recompile every shader")
+    ("shard", po::value<std::string>(),"Build only shard K of N, numbered from 0, chosen by a stable hash of every module's path. Combine the outputs of all shards with shaderfax merge")
+    ("dependency-graph", po::value<std::string>(),"Write the module dependency graph to a JSON file")
+    ("cache-dir", po::value<std::string>(),"Folder of compiled entry points and imported modules shared between builds and checkouts")
+    ("cache-size", po::value<uint64_t>()->default_value(2048),"Size limit of the cache folder in megabytes")
+    ("watch,w", "Keep running and rebuild shaders affected by changes under the root folder")
+    ("format", po::value<std::string>()->default_value("v1"),"Layout of .cshdr files, v1 or the indexed and mappable v2")
+    ("compression", po::value<std::string>()->default_value("none"),"Encoding of compiled code in v2 files and packs, none or spirv")
+    ("target", po::value<std::vector<std::string>>()->composing(),"Also generate glsl, hlsl or cpp code for every stage, may be repeated. Needs --format v2")
+    ("link", po::value<std::string>()->default_value("separate"),"separate links every entry point on its own, composite links all entry points of a module once, shared also puts them in a single module every stage of the file uses. shared needs --format v2")
+    ("pack", po::value<std::string>(),"Also write every compiled shader into a single .shpak archive")
+    ("layout-table", po::value<std::string>(),"Also write every distinct descriptor set layout of the build into a table that files reference by id. Needs --format v2")
+    ("config", po::value<std::string>(),"debug adds line information and doesn't optimize, release optimizes and strips names and line information. Without it code is compiled with Slang's defaults")
+    ("optimization,O", po::value<unsigned int>(),"Optimization level from 0 to 3, defaults to 0 for debug, 2 for release and 1 without --config")
+    ("debug-sidecar", "In release builds, write the stripped debug information to a .cshdr.dbg file next to every output")
+    ("profile", po::value<std::string>(),"Write a Chrome/Perfetto trace of every build phase, module and entry point to a JSON file")
+    ("profile-summary", po::value<size_t>()->implicit_value(10),"Print the time spent in every phase and the given number of slowest modules")
+    ("report", "Print how many bytes of code deduplication and debug stripping saved")
+    ("socket", po::value<std::string>(),"Unix socket shaderfax serve answers compile requests on, requests of separate connections compile in parallel on --jobs compilers")
     ;
 
     po::variables_map vm;
@@ -104,651 +194,1063 @@ int main(int argc, char**argv)
 
     std::filesystem::path root = vm["root"].as<std::string>();
     std::filesystem::path output = vm["output"].as<std::string>();
+    unsigned int jobs = vm["jobs"].as<unsigned int>();
+    if (jobs == 0)
+    {
+        jobs = std::max(1u,std::thread::hardware_concurrency());
+    }
 
+    BuildState state;
+    state.root = root;
+    state.output = output;
+    state.jobs = jobs;
+    state.maxInFlight = vm["max-in-flight"].as<size_t>()*1024*1024;
+    if (vm.count("shard"))
+    {
+        std::istringstream shard(vm["shard"].as<std::string>());
+        char separator = 0;
+        if (!(shard >> state.shardIndex >> separator >> state.shardCount) || !shard.eof() || separator != '/' || state.shardIndex >= state.shardCount)
+        {
+            std::cerr<< "Invalid shard "<<vm["shard"].as<std::string>()<<", expected K/N with K from 0 to N-1\n";
+            return EXIT_FAILURE;
+        }
+    }
+    auto format = vm["format"].as<std::string>();
+    if (format == "v2")
+    {
+        state.format = ShaderFileFormat::V2;
+    }
+    else if (format != "v1")
+    {
+        std::cerr<< "Unknown file format "<<format<<", expected v1 or v2\n";
+        return EXIT_FAILURE;
+    }
+    auto compression = vm["compression"].as<std::string>();
+    if (compression == "spirv")
+    {
+        if (state.format != ShaderFileFormat::V2)
+        {
+            std::cerr<< "Compression needs --format v2\n";
+            return EXIT_FAILURE;
+        }
+        state.encoding = shaderfax::BLOB_ENCODING_SPIRV;
+    }
+    else if (compression != "none")
+    {
+        std::cerr<< "Unknown compression "<<compression<<", expected none or spirv\n";
+        return EXIT_FAILURE;
+    }
+    //without a config the code is what Slang produces by default, so existing builds keep their output
+    unsigned int optimization = 1;
+    state.settings.debugInfo = SLANG_DEBUG_INFO_LEVEL_NONE;
+    if (vm.count("config"))
+    {
+        auto config = vm["config"].as<std::string>();
+        if (config == "release")
+        {
+            optimization = 2;
+            state.stripDebugInfo = true;
+            state.debugSidecar = vm.count("debug-sidecar");
+            //without a sidecar release builds don't ask for debug information at all, stripping then only removes names
+            state.settings.debugInfo = state.debugSidecar ? SLANG_DEBUG_INFO_LEVEL_STANDARD : SLANG_DEBUG_INFO_LEVEL_NONE;
+        }
+        else if (config == "debug")
+        {
+            optimization = 0;
+            state.settings.debugInfo = SLANG_DEBUG_INFO_LEVEL_STANDARD;
+        }
+        else
+        {
+            std::cerr<< "Unknown config "<<config<<", expected debug or release\n";
+            return EXIT_FAILURE;
+        }
+    }
+    if (vm.count("optimization"))
+    {
+        optimization = vm["optimization"].as<unsigned int>();
+    }
+    const SlangOptimizationLevel optimizationLevels[] = {SLANG_OPTIMIZATION_LEVEL_NONE,SLANG_OPTIMIZATION_LEVEL_DEFAULT,SLANG_OPTIMIZATION_LEVEL_HIGH,SLANG_OPTIMIZATION_LEVEL_MAXIMAL};
+    if (optimization >= std::size(optimizationLevels))
+    {
+        std::cerr<< "Unknown optimization level "<<optimization<<", expected 0 to 3\n";
+        return EXIT_FAILURE;
+    }
+    state.settings.optimization = optimizationLevels[optimization];
+    auto link = vm["link"].as<std::string>();
+    if (link == "composite")
+    {
+        state.settings.link = LinkMode::COMPOSITE;
+    }
+    else if (link == "shared")
+    {
+        if (state.format != ShaderFileFormat::V2)
+        {
+            std::cerr<< "Shared modules need --format v2\n";
+            return EXIT_FAILURE;
+        }
+        state.settings.link = LinkMode::SHARED;
+    }
+    else if (link != "separate")
+    {
+        std::cerr<< "Unknown link mode "<<link<<", expected separate, composite or shared\n";
+        return EXIT_FAILURE;
+    }
+    if (vm.count("target"))
+    {
+        for (auto& target: vm["target"].as<std::vector<std::string>>())
+        {
+            shaderfax::CodeTarget codeTarget;
+            if (target == "spirv")
+            {
+                continue;
+            }
+            else if (target == "glsl")
+            {
+                codeTarget = shaderfax::CODE_TARGET_GLSL;
+            }
+            else if (target == "hlsl")
+            {
+                codeTarget = shaderfax::CODE_TARGET_HLSL;
+            }
+            else if (target == "cpp")
+            {
+                codeTarget = shaderfax::CODE_TARGET_CPP;
+            }
+            else
+            {
+                std::cerr<< "Unknown target "<<target<<", expected spirv, glsl, hlsl or cpp\n";
+                return EXIT_FAILURE;
+            }
+            if (std::find(state.settings.targets.begin(),state.settings.targets.end(),codeTarget) == state.settings.targets.end())
+            {
+                state.settings.targets.push_back(codeTarget);
+            }
+        }
+        if (!state.settings.targets.empty() && state.format != ShaderFileFormat::V2)
+        {
+            std::cerr<< "Targets besides spirv need --format v2\n";
+            return EXIT_FAILURE;
+        }
+    }
+    //outputs written in another format have to be rebuilt
+    uint64_t optionsHash = hashCombine(hashCombine(ShaderCompiler::optionsHash(state.settings),(uint32_t)state.format),state.encoding);
+    state.manifest = BuildManifest(hashCombine(optionsHash,(uint32_t)state.stripDebugInfo | (uint32_t)state.debugSidecar << 1 | (uint32_t)vm.count("layout-table") << 2));
+    state.manifestFile = BuildManifest::manifestPathFor(output);
+    state.incremental = !vm.count("rebuild") && state.manifest.load(state.manifestFile);
+    if (vm.count("cache-dir"))
+    {
+        state.cache = std::make_unique<ShaderCache>(vm["cache-dir"].as<std::string>(),vm["cache-size"].as<uint64_t>()*1024*1024);
+    }
+    if (vm.count("dependency-graph"))
+    {
+        state.dependencyGraphFile = vm["dependency-graph"].as<std::string>();
+    }
+    if (vm.count("pack"))
+    {
+        state.packFile = vm["pack"].as<std::string>();
+    }
+    if (vm.count("layout-table"))
+    {
+        if (state.format != ShaderFileFormat::V2)
+        {
+            std::cerr<< "Layout tables need --format v2\n";
+            return EXIT_FAILURE;
+        }
+        state.layoutTableFile = vm["layout-table"].as<std::string>();
+    }
+    state.report = vm.count("report");
+    if (vm.count("profile"))
+    {
+        state.profileFile = vm["profile"].as<std::string>();
+    }
+    if (vm.count("profile-summary"))
+    {
+        state.profileSummary = std::max<size_t>(1,vm["profile-summary"].as<size_t>());
+    }
+    if (!state.profileFile.empty() || state.profileSummary > 0)
+    {
+        state.profiler = std::make_unique<Profiler>();
+    }
 
+    if (serving)
+    {
+        if (!vm.count("socket"))
+        {
+            std::cerr<< "shaderfax serve needs --socket\n";
+            return EXIT_FAILURE;
+        }
+        CompileServer server(state.root,state.settings,state.format,state.encoding,state.stripDebugInfo,state.jobs);
+        return server.serve(vm["socket"].as<std::string>()) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
-    Slang::ComPtr<IGlobalSession> globalSession;
-    SlangGlobalSessionDesc globalDesc{};
-    createGlobalSession(&globalDesc,globalSession.writeRef());
+    auto result = build(state);
+    reportProfile(state);
+    if (vm.count("watch"))
+    {
+        return watch(state);
+    }
+    return result;
+}
 
-    std::string absRoot = absolute(root).string();
-    const char* rootPath = absRoot.c_str();
-    TargetDesc targetDesc{};
-    targetDesc.format = SLANG_SPIRV;
+int build(BuildState& state)
+{
+    auto& root = state.root;
+    auto& output = state.output;
+    auto& manifest = state.manifest;
 
+    std::vector<std::filesystem::path> modulePaths;
+    ProfileScope walkScope(state.profiler.get(),"walk",root.generic_string());
+    getModulePaths(modulePaths,root);
+    walkScope.stop();
+    if (state.shardCount > 1)
+    {
+        std::erase_if(modulePaths,[&](const std::filesystem::path& path){return hashString(path.generic_string()) % state.shardCount != state.shardIndex;});
+    }
 
-    CompilerOptionEntry compilerOptions[]
+    std::vector<ModuleResult> results(modulePaths.size());
+    if (state.incremental)
     {
-        CompilerOptionEntry(CompilerOptionName::PreserveParameters,CompilerOptionValue(CompilerOptionValueKind::Int,true))
-    };
+        DependencyGraph previousGraph(manifest,root);
+        auto dirty = previousGraph.dependentsOf(previousGraph.changedFiles(manifest));
+        for (auto i=0; i< modulePaths.size(); i++)
+        {
+            auto source = modulePaths[i].generic_string();
+            auto entry = manifest.find(source);
+            auto outputFile = output/outputPathFor(modulePaths[i]);
+            results[i].upToDate = entry && !dirty.contains(source) && (!entry->hasOutput || (std::filesystem::exists(outputFile) && (!state.debugSidecar || std::filesystem::exists(debugPathFor(outputFile)))));
+        }
+    }
+    //modules are written while later ones compile, the queue bounds how much compiled code waits for the writer
+    std::filesystem::create_directory(output);
+    OutputQueue queue(state.maxInFlight);
+    OutputStats stats;
+    std::thread writer(writeOutputs,std::ref(state),std::ref(queue),std::ref(stats));
+    compileModules(modulePaths,state,results,queue);
+    queue.close();
+    writer.join();
+    if (state.cache)
+    {
+        state.cache->evict();
+    }
 
-    SessionDesc sessionDesc{};
-    sessionDesc.targets = &targetDesc;
-    sessionDesc.targetCount = 1;
-    sessionDesc.flags = kSessionFlags_None;
-    sessionDesc.defaultMatrixLayoutMode = SLANG_MATRIX_LAYOUT_COLUMN_MAJOR;
-    sessionDesc.searchPaths = &rootPath;
-    sessionDesc.searchPathCount = 1;
-    sessionDesc.preprocessorMacros = nullptr;
-    sessionDesc.preprocessorMacroCount = 0;
-    sessionDesc.fileSystem = nullptr;
-    sessionDesc.enableEffectAnnotations = false;
-    sessionDesc.enableEffectAnnotations = false;
-    sessionDesc.compilerOptionEntries = compilerOptions;
-    sessionDesc.compilerOptionEntryCount = sizeof(compilerOptions)/sizeof(CompilerOptionEntry);
-
-    Slang::ComPtr<ISession> session;
-    globalSession->createSession(sessionDesc, session.writeRef());
-    std::vector<IModule*> modules;
-
-    auto success = getModules(modules,root,session);
-    if (!success)
+    bool success = true;
+    size_t combinationCount = 0;
+    size_t distinctVariants = 0;
+    for (auto& result: results)
+    {
+        if (!result.processed)
+        {
+            continue;
+        }
+        std::cerr << result.errors;
+        success = success && result.success;
+        if (!result.matrix.empty())
+        {
+            combinationCount += result.matrix.combinationCount();
+            distinctVariants += result.distinctVariants;
+        }
+    }
+    if (!success || stats.failed)
     {
         return EXIT_FAILURE;
     }
 
-    std::unordered_map<std::string,ShaderFileData> shaderWriteData;
-    for (auto i=0; i< modules.size(); i++)
+    if (state.incremental)
     {
-        auto module = modules[i];
-        std::filesystem::path file = module->getFilePath();
-        file = absolute(file);
-        auto relative = std::filesystem::relative(file,root).replace_extension(".cshdr");
-
-        auto reflection = module->getModuleReflection();
-        auto layout = module->getLayout();
-        auto parameterCount = layout->getParameterCount();
-
-        std::vector<DescriptorSet> descriptorSets;
-
-        for (auto i=0; i<parameterCount; i++)
+        //only remove outputs whose source is gone, or that no longer define entry points
+        std::set<std::string> sources;
+        for (auto i=0; i< modulePaths.size(); i++)
         {
-            auto parameter = layout->getParameterByIndex(i);
-            auto paramType = parameter->getType();
-            auto paramKind = paramType->getKind();
-            if (paramKind == TypeReflection::Kind::ParameterBlock)
+            auto source = modulePaths[i].generic_string();
+            sources.insert(source);
+            auto previous = manifest.find(source);
+            if (results[i].processed && !results[i].hasEntryPoints && previous && previous->hasOutput)
             {
-                auto paramName = parameter->getName();
-                auto bindIndex = parameter->getBindingIndex();
-                auto paramLayout = parameter->getTypeLayout();
-
-                auto blockTypeLayout = paramLayout->getElementTypeLayout();
-
-                descriptorSets.push_back(DescriptorSet(paramName,blockTypeLayout,descriptorSets.size()));
+                std::error_code error;
+                std::filesystem::remove(output/outputPathFor(modulePaths[i]),error);
+                std::filesystem::remove(debugPathFor(output/outputPathFor(modulePaths[i])),error);
             }
+        }
+        std::vector<std::string> removedSources;
+        for (auto& kvPair: manifest.entries())
+        {
+            if (!sources.contains(kvPair.first))
+            {
+                removedSources.push_back(kvPair.first);
+            }
+        }
+        for (auto& source: removedSources)
+        {
+            if (manifest.find(source)->hasOutput)
+            {
+                std::error_code error;
+                std::filesystem::remove(output/outputPathFor(source),error);
+                std::filesystem::remove(debugPathFor(output/outputPathFor(source)),error);
+            }
+            manifest.erase(source);
+        }
+    }
+    else
+    {
+        removeFilesOfType(output,".cshdr",stats.written);
+        removeFilesOfType(output,".dbg",stats.written);
+    }
+    for (auto i=0; i< modulePaths.size(); i++)
+    {
+        if (!results[i].processed)
+        {
+            continue;
+        }
+        ManifestEntry entry{};
+        entry.hasOutput = results[i].hasEntryPoints;
+        manifest.hashFile(root/modulePaths[i],entry.sourceHash);
+        for (auto& dependency: results[i].dependencies)
+        {
+            ManifestDependency manifestDependency{.path = dependency.generic_string()};
+            manifest.hashFile(dependency,manifestDependency.hash);
+            entry.dependencies.push_back(manifestDependency);
+        }
+        manifest.set(modulePaths[i].generic_string(),std::move(entry));
+    }
 
+    if (state.report)
+    {
+        if (combinationCount > 0)
+        {
+            std::cout << "Variant matrices compiled "<<combinationCount<<" combinations into "<<distinctVariants<<" distinct variants\n";
+        }
+        if (state.stripDebugInfo)
+        {
+            printSizeTable(stats.sizes);
         }
+        std::cout << "Stages sharing code within a file saved "<<stats.duplicateBytes<<" bytes in "<<stats.fileCount<<" written files\n";
+    }
+    if (!state.packFile.empty() && !writePack(state))
+    {
+        return EXIT_FAILURE;
+    }
+    if (!state.layoutTableFile.empty() && !writeLayoutTable(state,stats.layouts))
+    {
+        return EXIT_FAILURE;
+    }
+    state.incremental = true;
+    state.compiledCount = std::count_if(results.begin(),results.end(),[](const ModuleResult& result){return result.processed;});
+    if (!manifest.save(state.manifestFile))
+    {
+        std::cerr<< "Unable to write build manifest "<<state.manifestFile<<"\n";
+    }
+    if (!state.dependencyGraphFile.empty())
+    {
+        std::filesystem::path graphFile = state.dependencyGraphFile;
+        DependencyGraph graph(manifest,root);
+        if (!graph.writeJson(graphFile,root))
+        {
+            std::cerr<< "Unable to write dependency graph "<<graphFile<<"\n";
+            return EXIT_FAILURE;
+        }
+    }
+    return 0;
+}
 
+///shaderfax merge combines the output folders or packs of sharded builds into one output folder or pack
+int merge(int argc, char** argv)
+{
+    po::options_description desc("Allowed options");
+    desc.add_options()
+    ("help,h", "produce help message")
+    ("input,i", po::value<std::vector<std::string>>()->composing(),"Output folder, .shpak archive or .sflt layout table of a shard, may be repeated or given without the option")
+    ("output,o", po::value<std::string>(),"Folder every shard's files are copied into")
+    ("pack", po::value<std::string>(),"Write every shard's files into a single .shpak archive, storing identical code once")
+    ("layout-table", po::value<std::string>(),"Write every distinct descriptor set layout of the shards into a single table")
+    ("report", "Print how many bytes of code the pack shares between files")
+    ;
+    po::positional_options_description positional;
+    positional.add("input",-1);
+
+    po::variables_map vm;
+    po::store(po::command_line_parser(argc,argv).options(desc).positional(positional).run(),vm);
+    if (vm.count("help") || !vm.count("input") || (!vm.count("output") && !vm.count("pack") && !vm.count("layout-table")))
+    {
+        std::cout << "Usage: Shaderfax merge [options] shard...\n" << desc << std::endl;
+        return vm.count("help") ? 0 : EXIT_FAILURE;
+    }
 
-        if (shaderWriteData.contains(relative.string()))
+    //relative path of every file to the shard it came from, shards must not overlap
+    std::map<std::string,std::filesystem::path> owners;
+    std::map<std::string,std::filesystem::path> files;
+    std::vector<std::filesystem::path> packs;
+    std::vector<std::filesystem::path> layoutTables;
+    auto addPath = [&](const std::string& relative, const std::filesystem::path& input)
+    {
+        auto [owner,added] = owners.insert({relative,input});
+        if (!added)
         {
-            std::cerr << "Shader is duplicating relative file path: "<< file << std::endl;
-            return EXIT_FAILURE;
+            std::cerr << "Shader is duplicating relative file path: "<< relative <<" is in "<<owner->second<<" and "<<input<< std::endl;
         }
-        auto insertData = shaderWriteData.insert({relative.string(),ShaderFileData{}});
-        auto& sfd = insertData.first->second;
-        sfd.descriptorSets=descriptorSets;
-
-        for (auto entryPointIndex = 0; entryPointIndex < module->getDefinedEntryPointCount(); entryPointIndex++)
-        {
-            Slang::ComPtr<IEntryPoint> entryPoint = nullptr;
-            module->getDefinedEntryPoint(entryPointIndex,entryPoint.writeRef());
-            auto reflection =entryPoint->getFunctionReflection();
-            auto funcName = reflection->getName();
-            auto layout = entryPoint->getLayout();
-            auto ep = layout->findEntryPointByName(funcName);
-            auto stage = ep->getStage();
-            std::string stageName = "";
-            std::vector<std::string> parameters;
-            ShaderType currentType = ShaderType::UNKNOWN;
-            GeometryPipelineType pipelineType = GeometryPipelineType::NA;
-
-            switch (stage)
+        return added;
+    };
+    for (auto& input: vm["input"].as<std::vector<std::string>>())
+    {
+        std::filesystem::path inputPath = input;
+        if (std::filesystem::is_directory(inputPath))
+        {
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(inputPath))
             {
-                case SLANG_STAGE_NONE:
-                    std::cerr << "encountered unknown entry point stage"<< module->getFilePath()<<": "<<reflection->getName()<<"\n";
-                    return EXIT_FAILURE;
-                    break;
-                case SLANG_STAGE_VERTEX:
-                    if (!isSameShaderType(currentType,ShaderType::GRAPHICS,pipelineType,GeometryPipelineType::VERTEX,module->getFilePath())){return EXIT_FAILURE;}
-                    stageName = "vertex";
-                    parameters = getVertexParameters(reflection);
-                    break;
-                case SLANG_STAGE_HULL:
-                    if (!isSameShaderType(currentType,ShaderType::GRAPHICS,pipelineType,GeometryPipelineType::VERTEX,module->getFilePath())){return EXIT_FAILURE;}
-                    stageName = "hull";
-                    parameters = getHullParameters(reflection);
-                    break;
-                case SLANG_STAGE_DOMAIN:
-                    if (!isSameShaderType(currentType,ShaderType::GRAPHICS,pipelineType,GeometryPipelineType::VERTEX,module->getFilePath())){return EXIT_FAILURE;}
-                    stageName = "domain";
-                    parameters = getDomainParameters(reflection);
-                    break;
-                case SLANG_STAGE_GEOMETRY:
-                    if (!isSameShaderType(currentType,ShaderType::GRAPHICS,pipelineType,GeometryPipelineType::VERTEX,module->getFilePath())){return EXIT_FAILURE;}
-                    stageName = "geometry";
-                    parameters = getGeometryParameters(reflection);
-                    break;
-                case SLANG_STAGE_FRAGMENT:
-                    if (!isSameShaderType(currentType,ShaderType::GRAPHICS,pipelineType,GeometryPipelineType::VERTEX,module->getFilePath())){return EXIT_FAILURE;}
-                    stageName = "fragment";
-                    if (!getFragmentParameters(reflection,parameters,file))
-                    {
-                        return EXIT_FAILURE;
-                    }
-                    break;
-                case SLANG_STAGE_COMPUTE:
-                    if (!isSameShaderType(currentType,ShaderType::COMPUTE,pipelineType,GeometryPipelineType::NA,module->getFilePath())){return EXIT_FAILURE;}
-                    stageName = "compute";
-                    parameters = getComputeParameters(reflection);
-                    break;
-                case SLANG_STAGE_RAY_GENERATION:
-                    if (!isSameShaderType(currentType,ShaderType::RAY,pipelineType,GeometryPipelineType::NA,module->getFilePath())){return EXIT_FAILURE;}
-                    stageName = "rayGeneration";
-                    parameters = getRayGenerationParameters(reflection);
-                    break;
-                case SLANG_STAGE_INTERSECTION:
-                    if (!isSameShaderType(currentType,ShaderType::RAY,pipelineType,GeometryPipelineType::NA,module->getFilePath())){return EXIT_FAILURE;}
-                    stageName = "intersection";
-                    parameters = getIntersectionParameters(reflection);
-                    break;
-                case SLANG_STAGE_ANY_HIT:
-                    if (!isSameShaderType(currentType,ShaderType::RAY,pipelineType,GeometryPipelineType::NA,module->getFilePath())){return EXIT_FAILURE;}
-                    stageName = "anyHit";
-                    parameters = getAnyHitParameters(reflection);
-                    break;
-                case SLANG_STAGE_CLOSEST_HIT:
-                    if (!isSameShaderType(currentType,ShaderType::RAY,pipelineType,GeometryPipelineType::NA,module->getFilePath())){return EXIT_FAILURE;}
-                    stageName = "closestHit";
-                    parameters = getClosestHitParameters(reflection);
-                    break;
-                case SLANG_STAGE_MISS:
-                    if (!isSameShaderType(currentType,ShaderType::RAY,pipelineType,GeometryPipelineType::NA,module->getFilePath())){return EXIT_FAILURE;}
-                    stageName = "miss";
-                    parameters = getMissParameters(reflection);
-                    break;
-                case SLANG_STAGE_CALLABLE:
-                    if (!isSameShaderType(currentType,ShaderType::RAY,pipelineType,GeometryPipelineType::NA,module->getFilePath())){return EXIT_FAILURE;}
-                    stageName = "callable";
-                    parameters = getCallableParameters(reflection);
-                    break;
-                case SLANG_STAGE_MESH:
-                    if (!isSameShaderType(currentType,ShaderType::RAY,pipelineType,GeometryPipelineType::MESH,module->getFilePath())){return EXIT_FAILURE;}
-                    stageName = "mesh";
-                    parameters = getMeshParameters(reflection);
-                    break;
-                case SLANG_STAGE_AMPLIFICATION:
-                    if (!isSameShaderType(currentType,ShaderType::RAY,pipelineType,GeometryPipelineType::MESH,module->getFilePath())){return EXIT_FAILURE;}
-                    stageName = "task";
-                    parameters = getAmplificationParameters(reflection);
-                    break;
-                default:
-                    std::cerr << "encountered unknown entry point stage"<< module->getFilePath()<<": "<<reflection->getName()<<"\n";
+                if (!entry.is_regular_file() || entry.path().extension() != ".cshdr")
+                {
+                    continue;
+                }
+                auto relative = std::filesystem::relative(entry.path(),inputPath).generic_string();
+                if (!addPath(relative,inputPath))
+                {
                     return EXIT_FAILURE;
-                    break;
-
+                }
+                files[relative] = entry.path();
             }
-
-            Slang::ComPtr<IComponentType> componentType;
-            Slang::ComPtr<IBlob> diagnostics;
-            entryPoint->link(componentType.writeRef(),diagnostics.writeRef());
-            if (diagnostics.get())
+        }
+        else if (inputPath.extension() == ".shpak")
+        {
+            shaderfax::ShaderPack pack;
+            if (!pack.open(inputPath))
             {
-                std::cerr<<(char*)diagnostics->getBufferPointer()<<"\n";
+                std::cerr<< "Unable to read shader pack "<<inputPath<<"\n";
                 return EXIT_FAILURE;
             }
-            Slang::ComPtr<IBlob> spirv = nullptr;
-            diagnostics = nullptr;
-            componentType->getTargetCode(0,spirv.writeRef(),diagnostics.writeRef());
-            if (spirv.get() == nullptr)
+            for (auto i=0; i<pack.size(); ++i)
             {
-                if (diagnostics.get())
+                if (!addPath(std::string(pack.path(i)),inputPath))
                 {
-                    std::cerr<<(char*)diagnostics->getBufferPointer()<<"\n";
+                    return EXIT_FAILURE;
                 }
-                return EXIT_FAILURE;
             }
-            diagnostics = nullptr;
-
-            sfd.shaderOutData.push_back({.stage = stageName,.parameters = std::move(parameters),.spirvCode = spirv});
+            packs.push_back(inputPath);
+        }
+        else if (inputPath.extension() == ".sflt")
+        {
+            //files of shards built with a layout table only name their descriptors
+            layoutTables.push_back(inputPath);
+        }
+        else
+        {
+            std::cerr<< input<<" is neither an output folder, a .shpak archive nor a .sflt layout table\n";
+            return EXIT_FAILURE;
         }
-
     }
-    removeFilesOfType(output,".cshdr");
-    std::filesystem::create_directory(output);
-    for (auto& kvpair: shaderWriteData)
-    {
-        std::string relativeName = kvpair.first;
-        std::filesystem::path file = output/relativeName;
-        auto& writeData = kvpair.second;
-        std::vector<char> data;
-        data.push_back('c');
-        data.push_back('s');
-        data.push_back('h');
-        data.push_back('d');
-        data.push_back('r');
-        data.push_back('\n');
-        uint8_t descriptorGroupCount = writeData.descriptorSets.size();
-        if constexpr (std::endian::native == std::endian::big)
-        {
-            boost::endian::native_to_little_inplace(descriptorGroupCount);
-        }
-        data.push_back(*(char*)(&descriptorGroupCount));
-        for (auto i=0; i< writeData.descriptorSets.size(); ++i)
-        {
-            auto& descriptorSet = writeData.descriptorSets[i];
-            uint8_t descriptorCount = descriptorSet.descriptorCount();
-            boost::endian::native_to_little_inplace(descriptorCount);
-            data.push_back(*(char*)(&descriptorCount));
-            for (auto j=0; j< descriptorSet.descriptorCount(); ++j)
+
+    if (vm.count("output"))
+    {
+        //files in a pack point into its shared code and can't be copied out on their own
+        if (!packs.empty())
+        {
+            std::cerr<< "Shards packed into .shpak archives can only be merged into a pack\n";
+            return EXIT_FAILURE;
+        }
+        std::filesystem::path output = vm["output"].as<std::string>();
+        std::set<std::filesystem::path> written;
+        for (auto& [relative,file]: files)
+        {
+            auto target = output/relative;
+            std::error_code error;
+            std::filesystem::create_directories(target.parent_path(),error);
+            std::filesystem::copy_file(file,target,std::filesystem::copy_options::overwrite_existing,error);
+            if (!error && std::filesystem::exists(debugPathFor(file)))
             {
-                auto& descriptor = descriptorSet.at(j);
-                for (auto k=0; k< descriptor.name.size(); ++k)
-                {
-                    data.push_back(*(char*)(&descriptor.name[k]));
-                }
-                data.push_back('\0');
-                uint32_t index = descriptor.index;
-                boost::endian::native_to_little_inplace(index);
-                for (int k=0; k<sizeof(uint32_t); ++k)
-                {
-                    data.push_back(*(((char*)&index)+k));
-                }
-                //write type
-                uint8_t type = descriptor.type;
-                boost::endian::native_to_little_inplace(type);
-                data.push_back(*(char*)(&type));
-                //write count
-                uint32_t count = descriptor.count;
-                boost::endian::native_to_little_inplace(count);
-                for (int k=0; k<sizeof(uint32_t); ++k)
-                {
-                    data.push_back(*(((char*)&count)+k));
-                }
+                std::filesystem::copy_file(debugPathFor(file),debugPathFor(target),std::filesystem::copy_options::overwrite_existing,error);
+                written.insert(debugPathFor(target).lexically_normal());
             }
+            if (error)
+            {
+                std::cerr<< "Unable to copy "<<file<<" to "<<target<<": "<<error.message()<<"\n";
+                return EXIT_FAILURE;
+            }
+            written.insert(target.lexically_normal());
         }
+        removeFilesOfType(output,".cshdr",written);
+        removeFilesOfType(output,".dbg",written);
+    }
 
-        for (auto stageIndex=0; stageIndex<writeData.shaderOutData.size(); ++stageIndex)
+    if (vm.count("pack"))
+    {
+        std::filesystem::path packFile = vm["pack"].as<std::string>();
+        ShaderPackWriter pack;
+        for (auto& [relative,file]: files)
         {
-            auto& stage = writeData.shaderOutData[stageIndex];
-            for (auto i=0; i<stage.stage.size(); ++i)
+            if (!pack.addFile(relative,file))
             {
-                data.push_back(stage.stage[i]);
+                std::cerr<< "Unable to read "<<file<<" into the shader pack\n";
+                return EXIT_FAILURE;
             }
-            data.push_back(':');
-            data.push_back('<');
-            for (auto i=0; i<stage.parameters.size(); ++i)
+        }
+        for (auto& input: packs)
+        {
+            if (!pack.addPack(input))
             {
-                auto& parameter = stage.parameters[i];
-                for (auto j=0; j<parameter.size(); ++j)
-                {
-                    data.push_back(parameter[j]);
-                }
-                if (i<stage.parameters.size()-1)
-                {
-                    data.push_back(',');
-                }
+                std::cerr<< "Unable to read "<<input<<" into the shader pack\n";
+                return EXIT_FAILURE;
             }
-            data.push_back('>');
-            uint32_t bufferSize = stage.spirvCode->getBufferSize();
-            if constexpr (std::endian::native == std::endian::big)
+        }
+        pack.finish();
+        if (pack.write(packFile) == WriteResult::FAILED)
+        {
+            std::cerr<< "Unable to write shader pack "<<packFile<<"\n";
+            return EXIT_FAILURE;
+        }
+        if (vm.count("report"))
+        {
+            std::cout << "Shader pack stores "<<pack.uniqueBlobCount()<<" unique blobs of "<<pack.blobCount()
+                      <<", sharing code between files saved "<<pack.duplicateBytes()<<" bytes\n";
+        }
+    }
+    if (vm.count("layout-table"))
+    {
+        //ids are content hashes, so the layouts of every shard's files combine without renumbering them
+        std::filesystem::path tableFile = vm["layout-table"].as<std::string>();
+        LayoutTableWriter table;
+        for (auto& input: layoutTables)
+        {
+            shaderfax::LayoutTable shardTable;
+            if (!shardTable.open(input))
             {
-                boost::endian::little_to_native_inplace(bufferSize);
+                std::cerr<< "Unable to read layout table "<<input<<"\n";
+                return EXIT_FAILURE;
             }
-            char* location = (char*)&bufferSize;
-            for (auto byte=0; byte<sizeof(bufferSize); ++byte)
+            table.addLayouts(shardTable);
+        }
+        for (auto& [relative,file]: files)
+        {
+            shaderfax::ShaderFile shaderFile;
+            if (!shaderFile.open(file))
             {
-                data.push_back(location[byte]);
+                std::cerr<< "Unable to read "<<file<<"\n";
+                return EXIT_FAILURE;
             }
-            char* bufferBegin = (char*)stage.spirvCode->getBufferPointer();
-            for (auto currentByte = 0; currentByte<stage.spirvCode->getBufferSize(); ++currentByte)
+            if (!addToLayoutTable(table,shaderFile,file))
             {
-                data.push_back(bufferBegin[currentByte]);
+                return EXIT_FAILURE;
             }
         }
-        auto directory = file.parent_path();
-        if (!std::filesystem::exists(directory))
+        for (auto& input: packs)
         {
-            std::filesystem::create_directory(directory);
+            shaderfax::ShaderPack pack;
+            if (!pack.open(input))
+            {
+                std::cerr<< "Unable to read shader pack "<<input<<"\n";
+                return EXIT_FAILURE;
+            }
+            for (auto i=0; i<pack.size(); ++i)
+            {
+                shaderfax::ShaderFileView shaderFile;
+                if (!pack.file(i,shaderFile))
+                {
+                    std::cerr<< "Unable to read "<<pack.path(i)<<" in "<<input<<"\n";
+                    return EXIT_FAILURE;
+                }
+                if (!addToLayoutTable(table,shaderFile,input/pack.path(i)))
+                {
+                    return EXIT_FAILURE;
+                }
+            }
         }
-        std::ofstream outFile(file, std::ios::trunc|std::ios::binary);
-        if (outFile.is_open())
+        table.finish();
+        if (table.write(tableFile) == WriteResult::FAILED)
         {
-            outFile.write(data.data(),data.size());
-            outFile.close();
+            std::cerr<< "Unable to write layout table "<<tableFile<<"\n";
+            return EXIT_FAILURE;
         }
-        else
+        if (vm.count("report"))
         {
-            std::cerr<< "Unable to write to file "<<file<<"\n";
-            return EXIT_FAILURE;
+            std::cout << "Layout table holds "<<table.layoutCount()<<" distinct layouts of "<<table.setCount()<<" descriptor sets\n";
         }
-
     }
+    std::cout << "Merged "<<owners.size()<<" files from "<<vm["input"].as<std::vector<std::string>>().size() - layoutTables.size()<<" shards"<<std::endl;
     return 0;
 }
 
-bool getModules(std::vector<IModule*>& modules,std::filesystem::path& root,Slang::ComPtr<ISession>& session)
+bool writePack(BuildState& state)
 {
-    using recursive_directory_iterator = std::filesystem::recursive_directory_iterator;
-    for (const auto& dirEntry : recursive_directory_iterator(root))
+    ProfileScope scope(state.profiler.get(),"pack",state.packFile.generic_string());
+    //modules skipped by an incremental build only exist on disk, so the pack is always assembled from the output folder
+    ShaderPackWriter pack;
+    for (auto& kvPair: state.manifest.entries())
     {
-        if (dirEntry.is_regular_file())
+        if (!kvPair.second.hasOutput)
         {
-            auto path = dirEntry.path();
-            path = std::filesystem::relative(path, root);
-            if (path.extension() == ".slang")
-            {
-                Slang::ComPtr<IBlob> diagnostics;
-                IModule* module = session->loadModule(path.string().c_str(),diagnostics.writeRef());
-                if (module && module->getDefinedEntryPointCount())
-                {
-                    bool compute = false;
-                    bool graphics = false;
-                    for (auto i=0; i< module->getDefinedEntryPointCount(); i++)
-                    {
-                        IEntryPoint* entryPoint = nullptr;
-                        module->getDefinedEntryPoint(i,&entryPoint);
-                        auto reflection =entryPoint->getFunctionReflection();
-                        auto funcName = reflection->getName();
-                        auto layout = entryPoint->getLayout();
-                        auto ep = layout->findEntryPointByName(funcName);
-                        auto stage = ep->getStage();
-                        if (stage == SLANG_STAGE_COMPUTE)
-                        {
-                            compute = true;
-                        }
-                        else
-                        {
-                            graphics = true;
-                        }
-                    }
-                    if (compute && graphics)
-                    {
-                        std::cerr << path << " contains both compute and graphics entry points\n";
-                        return false;
-                    }
-                    else
-                    {
-                        modules.push_back(module);
-                    }
-                }
-
-                if (diagnostics)
-                {
-                    std::cerr << (char*)diagnostics->getBufferPointer() << std::endl;
-                    return false;
-                }
-            }
+            continue;
         }
+        auto relative = outputPathFor(kvPair.first);
+        if (!pack.addFile(relative.generic_string(),state.output/relative))
+        {
+            std::cerr<< "Unable to read "<<state.output/relative<<" into the shader pack\n";
+            return false;
+        }
+    }
+    pack.finish();
+    if (pack.write(state.packFile) == WriteResult::FAILED)
+    {
+        std::cerr<< "Unable to write shader pack "<<state.packFile<<"\n";
+        return false;
+    }
+    if (state.report)
+    {
+        std::cout << "Shader pack stores "<<pack.uniqueBlobCount()<<" unique blobs of "<<pack.blobCount()
+                  <<", sharing code between files saved "<<pack.duplicateBytes()<<" bytes\n";
     }
     return true;
 }
 
-bool isSameShaderType(ShaderType& existingType, ShaderType comparisonType, GeometryPipelineType& existingPipeline, GeometryPipelineType comparisonPipeline, const std::filesystem::path& currentFile)
+bool writeLayoutTable(BuildState& state, LayoutTableWriter& table)
 {
-    if (existingType == ShaderType::UNKNOWN)
+    ProfileScope scope(state.profiler.get(),"layouts",state.layoutTableFile.generic_string());
+    //like the pack, the table is assembled from the output folder so it covers modules an incremental build skipped. Their
+    //files only name their descriptors, so their layouts come from the table the previous build wrote
+    if (state.incremental && std::filesystem::exists(state.layoutTableFile))
     {
-        existingType = comparisonType;
-        existingPipeline = comparisonPipeline;
-        return true;
+        shaderfax::LayoutTable previous;
+        if (!previous.open(state.layoutTableFile))
+        {
+            std::cerr<< "Unable to read layout table "<<state.layoutTableFile<<"\n";
+            return false;
+        }
+        table.addLayouts(previous);
     }
-    else
+    for (auto& kvPair: state.manifest.entries())
     {
-        if (existingType == comparisonType)
+        if (!kvPair.second.hasOutput)
         {
-            if (comparisonPipeline == GeometryPipelineType::NA)
-            {
-                return true;
-            }
-            else if (existingPipeline == GeometryPipelineType::NA)
-            {
-                existingPipeline = comparisonPipeline;
-                return true;
-            }
-            else
-            {
-                std::cerr << "Shader defines multiple pipeline geometry execution paths";
-                return false;
-            }
-
+            continue;
         }
-        std::cerr << "Shader defines multiple pipelines: "<<currentFile<<"\n";
+        auto file = state.output/outputPathFor(kvPair.first);
+        shaderfax::ShaderFile shaderFile;
+        if (!shaderFile.open(file))
+        {
+            std::cerr<< "Unable to read "<<file<<" into the layout table\n";
+            return false;
+        }
+        if (!addToLayoutTable(table,shaderFile,file))
+        {
+            return false;
+        }
+    }
+    table.finish();
+    if (table.write(state.layoutTableFile) == WriteResult::FAILED)
+    {
+        std::cerr<< "Unable to write layout table "<<state.layoutTableFile<<"\n";
         return false;
     }
+    if (state.report)
+    {
+        std::cout << "Layout table holds "<<table.layoutCount()<<" distinct layouts of "<<table.setCount()<<" descriptor sets\n";
+    }
+    return true;
 }
 
+bool addToLayoutTable(LayoutTableWriter& table, const shaderfax::ShaderFileView& file, const std::filesystem::path& path)
+{
+    std::ostringstream errors;
+    if (!table.addFile(file,errors))
+    {
+        std::cerr<< "Unable to add "<<path<<" to the layout table, "<<errors.str();
+        return false;
+    }
+    return true;
+}
 
-std::vector<std::string> getVertexParameters(FunctionReflection* reflection)
+int watch(BuildState& state)
 {
-    std::vector<std::string> parameters;
-    auto parameterCount = reflection->getParameterCount();
-    for (auto i = 0; i < parameterCount; i++)
+    FileWatcher watcher(state.root);
+    if (!watcher.isValid())
     {
-        auto parameter = reflection->getParameterByIndex(i);
-        std::string inputType = parameter->getType()->getName();
-        if (inputType == "Vertex3D")
-        {
-            parameters.push_back(inputType);
-        }
-        else if (inputType == "Vertex2D")
+        std::cerr << "Unable to watch "<<state.root<<" for changes\n";
+        return EXIT_FAILURE;
+    }
+    //everything a build writes may live under the root folder, and must not start the next build
+    std::vector<std::filesystem::path> written = {state.output,state.manifestFile,state.packFile,state.layoutTableFile,state.dependencyGraphFile,state.profileFile};
+    if (state.cache)
+    {
+        written.push_back(state.cache->directory());
+    }
+    for (auto& path: written)
+    {
+        if (!path.empty())
         {
-            parameters.push_back(inputType);
+            watcher.ignore(path);
         }
-        else if (inputType == "Normal")
+    }
+    std::cout << "Watching "<<state.root<<" for changes"<<std::endl;
+
+    std::vector<std::filesystem::path> changed;
+    while (watcher.waitForChanges(changed,WATCH_DEBOUNCE))
+    {
+        //only modules and the files they were compiled from are sources, editors and other tools write plenty besides them
+        std::set<std::string> dependencies;
+        for (auto& [source,entry]: state.manifest.entries())
         {
-            parameters.push_back(inputType);
+            for (auto& dependency: entry.dependencies)
+            {
+                dependencies.insert(std::filesystem::path(dependency.path).lexically_normal().generic_string());
+            }
         }
-        else if (inputType == "Tangent")
+        bool sourceChanged = false;
+        for (auto& file: changed)
         {
-            parameters.push_back(inputType);
+            if (file.extension() != ".slang" && !dependencies.contains(file.lexically_normal().generic_string()))
+            {
+                continue;
+            }
+            state.manifest.forgetFileHash(file);
+            sourceChanged = true;
         }
-        else if (inputType == "UVCoordinates")
+        changed.clear();
+        if (!sourceChanged)
         {
-            parameters.push_back(inputType);
+            continue;
         }
-        else if (inputType == "VertexColor")
+
+        auto start = std::chrono::steady_clock::now();
+        auto result = build(state);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now()-start);
+        reportProfile(state);
+        if (result == EXIT_SUCCESS)
         {
-            parameters.push_back(inputType);
+            std::cout << "Rebuilt "<<state.compiledCount<<" modules in "<<elapsed.count()<<"ms"<<std::endl;
         }
-        else if (inputType == "BoneWeights")
+        else
         {
-            parameters.push_back(inputType);
+            std::cout << "Build failed after "<<elapsed.count()<<"ms"<<std::endl;
         }
     }
-
-    return parameters;
-}
-std::vector<std::string> getHullParameters(FunctionReflection* reflection)
-{
-    return std::vector<std::string>();
+    std::cerr << "Stopped watching "<<state.root<<"\n";
+    return EXIT_FAILURE;
 }
-std::vector<std::string> getDomainParameters(FunctionReflection* reflection)
-{
-    return std::vector<std::string>();
-}
-std::vector<std::string> getGeometryParameters(FunctionReflection* reflection)
+
+
+void getModulePaths(std::vector<std::filesystem::path>& modulePaths,std::filesystem::path& root)
 {
-    return std::vector<std::string>();
+    using recursive_directory_iterator = std::filesystem::recursive_directory_iterator;
+    for (const auto& dirEntry : recursive_directory_iterator(root))
+    {
+        if (dirEntry.is_regular_file())
+        {
+            auto path = dirEntry.path();
+            path = std::filesystem::relative(path, root);
+            if (path.extension() == ".slang")
+            {
+                modulePaths.push_back(path);
+            }
+        }
+    }
+    //directory iteration order is unspecified, sort so diagnostics are reported in a stable order
+    std::sort(modulePaths.begin(),modulePaths.end());
 }
-bool getFragmentParameters(FunctionReflection* reflection, std::vector<std::string>& parameters, const std::filesystem::path& currentFile)
+
+void compileModules(const std::vector<std::filesystem::path>& modulePaths,BuildState& state,std::vector<ModuleResult>& results,OutputQueue& queue)
 {
-    auto attributeCount = reflection->getUserAttributeCount();
-    std::unordered_map<uint8_t,std::string> colorTargets;
-    std::string depthTarget="";
-    bool foundDepth = false;
-    if (attributeCount)
+    //every combination of a variant matrix is compiled on its own, so the variants of a single module compile in parallel
+    struct WorkItem
+    {
+        size_t module = 0;
+        size_t combination = 0;
+    };
+    std::vector<WorkItem> items;
+    std::vector<std::atomic<size_t>> remainingCombinations(modulePaths.size());
+    for (auto i=0; i< modulePaths.size(); i++)
     {
+        auto& result = results[i];
+        if (result.upToDate)
+        {
+            continue;
+        }
+        std::ostringstream errors;
+        if (!result.matrix.load(state.root/modulePaths[i],errors) || (!result.matrix.empty() && state.format != ShaderFileFormat::V2))
+        {
+            if (!result.matrix.empty())
+            {
+                errors << modulePaths[i]<<" declares variants, which need --format v2\n";
+            }
+            result.processed = true;
+            result.success = false;
+            result.errors = errors.str();
+            continue;
+        }
+        if (result.matrix.empty())
+        {
+            items.push_back({.module = (size_t)i,.combination = 0});
+            continue;
+        }
+        result.combinations.resize(result.matrix.combinationCount());
+        remainingCombinations[i] = result.combinations.size();
+        for (auto j=0; j< result.combinations.size(); j++)
+        {
+            items.push_back({.module = (size_t)i,.combination = (size_t)j});
+        }
+    }
 
-        for (auto i = 0; i < attributeCount; i++)
+    std::atomic<size_t> nextItem = 0;
+    std::atomic<bool> failed = false;
+    auto worker = [&](size_t workerIndex)
+    {
+        //compilers outlive the build so their global sessions stay warm, but the session is recreated so edited modules are reloaded
+        auto& existing = state.compilers[workerIndex];
+        if (existing)
+        {
+            existing->resetSession();
+        }
+        else
+        {
+            existing = std::make_unique<ShaderCompiler>(state.root,state.settings);
+            existing->setCache(state.cache.get());
+            existing->setProfiler(state.profiler.get());
+        }
+        auto& compiler = *existing;
+        std::vector<ShaderMacro> macros;
+        for (size_t item = nextItem++; item < items.size() && !failed; item = nextItem++)
         {
-            auto attribute = reflection->getUserAttributeByIndex(i);
-            std::string attributeName = attribute->getName();
-            if (attributeName=="OutputColorTarget")
+            auto i = items[item].module;
+            auto& matrix = results[i].matrix;
+            auto& result = matrix.empty() ? results[i] : results[i].combinations[items[item].combination];
+            matrix.macros(items[item].combination,macros);
+            compiler.setMacros(macros);
+            std::string name = modulePaths[i].generic_string();
+            for (auto& macro: macros)
             {
-                int index = 0;
-                auto v = attribute->getArgumentValueInt(0,&index);
-                int type = 0;
-                attribute->getArgumentValueInt(1,&type);
-                auto target = TexelText[(TexelFormat)type];
-                colorTargets[index] = target;
+                name += " " + macro.name + "=" + macro.value;
             }
-            else if (attributeName=="OutputDepthTarget")
+            ProfileScope scope(state.profiler.get(),"module",name,modulePaths[i].generic_string());
+            std::ostringstream errors;
+            IModule* module = nullptr;
+            result.processed = true;
+            result.success = compiler.loadModule(modulePaths[i],module,errors);
+            if (result.success && module)
             {
-                if (!foundDepth)
+                ShaderCompiler::getDependencies(module,result.dependencies);
+                result.hasEntryPoints = module->getDefinedEntryPointCount() > 0;
+                if (result.hasEntryPoints)
                 {
-                    foundDepth = true;
+                    result.success = compiler.compileModule(module,result.fileData,errors);
                 }
-                else
-                {
-                    std::cerr << "Multiple Depth targets defined for fragment stage: "<<currentFile<<"\n";
-                    return false;
-                }
-                int type = 0;
-                attribute->getArgumentValueInt(0,&type);
-                depthTarget = TexelText[(TexelFormat)type];
+            }
+            result.errors = errors.str();
+            if (!result.success)
+            {
+                failed = true;
+            }
+            scope.stop();
+
+            //the worker finishing the last combination of a matrix merges them
+            if (!matrix.empty() && --remainingCombinations[i] > 0)
+            {
+                continue;
+            }
+            auto& moduleResult = results[i];
+            mergeCombinations(moduleResult);
+            if (moduleResult.success && moduleResult.hasEntryPoints)
+            {
+                auto size = codeSize(moduleResult.fileData);
+                queue.push({.relativePath = outputPathFor(modulePaths[i]),.fileData = std::move(moduleResult.fileData),.size = size});
             }
         }
+    };
+
+    size_t threadCount = std::min<size_t>(state.jobs,items.size());
+    if (state.compilers.size() < threadCount)
+    {
+        state.compilers.resize(threadCount);
     }
-    if (colorTargets.size()==0&&!foundDepth)
+    if (threadCount == 1)
     {
-        parameters.push_back("R8G8B8A8_UNORM");
-        parameters.push_back("D32_FLOAT");
+        worker(0);
     }
-    else
+    else if (threadCount > 1)
     {
-        for (auto& kvPair: colorTargets)
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount);
+        for (auto i=0; i<threadCount; ++i)
         {
-            parameters.push_back(kvPair.second);
+            threads.emplace_back(worker,i);
         }
-        if (foundDepth)
+        for (auto& thread: threads)
         {
-            parameters.push_back(depthTarget);
+            thread.join();
         }
     }
-    return true;
-}
-std::vector<std::string> getComputeParameters(FunctionReflection* reflection)
-{
-    return std::vector<std::string>();
-}
-std::vector<std::string> getRayGenerationParameters(FunctionReflection* reflection)
-{
-    return std::vector<std::string>();
-}
-std::vector<std::string> getIntersectionParameters(FunctionReflection* reflection)
-{
-    return std::vector<std::string>();
+
+    //matrices a failed build stopped compiling still report the errors of their combinations
+    for (auto& result: results)
+    {
+        mergeCombinations(result);
+    }
 }
-std::vector<std::string> getAnyHitParameters(FunctionReflection* reflection)
+
+void mergeCombinations(ModuleResult& result)
 {
-    return std::vector<std::string>();
+    if (result.combinations.empty())
+    {
+        return;
+    }
+    result.success = true;
+    for (auto& combination: result.combinations)
+    {
+        result.processed = result.processed || combination.processed;
+        result.success = result.success && combination.processed && combination.success;
+        result.hasEntryPoints = result.hasEntryPoints || combination.hasEntryPoints;
+        result.errors += combination.errors;
+        result.dependencies.insert(result.dependencies.end(),combination.dependencies.begin(),combination.dependencies.end());
+    }
+    //combinations may include different files, but mostly share them
+    std::sort(result.dependencies.begin(),result.dependencies.end());
+    result.dependencies.erase(std::unique(result.dependencies.begin(),result.dependencies.end()),result.dependencies.end());
+    if (result.success && result.hasEntryPoints)
+    {
+        std::vector<ShaderFileData> outputs;
+        for (auto& combination: result.combinations)
+        {
+            outputs.push_back(std::move(combination.fileData));
+        }
+        result.distinctVariants = result.matrix.merge(outputs,result.fileData);
+    }
+    result.combinations.clear();
 }
-std::vector<std::string> getClosestHitParameters(FunctionReflection* reflection)
+
+///Runs on its own thread for the whole build and writes modules in the order they finish compiling
+void writeOutputs(BuildState& state,OutputQueue& queue,OutputStats& stats)
 {
-    return std::vector<std::string>();
+    PendingOutput pending;
+    while (queue.pop(pending))
+    {
+        if (!stats.failed && !writeOutput(state,pending,stats))
+        {
+            stats.failed = true;
+            queue.abandon();
+        }
+        //the linked programs are gone by now, so dropping the file data frees the code the queue accounted for
+        auto size = pending.size;
+        pending = {};
+        queue.release(size);
+    }
 }
-std::vector<std::string> getMissParameters(FunctionReflection* reflection)
+
+bool writeOutput(BuildState& state,PendingOutput& pending,OutputStats& stats)
 {
-    return std::vector<std::string>();
+    std::string relativeName = pending.relativePath.string();
+    std::filesystem::path file = state.output/pending.relativePath;
+    if (!stats.written.insert(file.lexically_normal()).second)
+    {
+        std::cerr << "Shader is duplicating relative file path: "<< file << std::endl;
+        return false;
+    }
+    auto directory = file.parent_path();
+    if (!std::filesystem::exists(directory))
+    {
+        std::filesystem::create_directories(directory);
+    }
+    //files referencing the layout table only name their descriptors
+    bool sharedLayouts = !state.layoutTableFile.empty();
+    if (sharedLayouts)
+    {
+        stats.layouts.addLayouts(pending.fileData);
+    }
+    if (state.debugSidecar)
+    {
+        ShaderFileWriter debugWriter(pending.fileData,state.format,state.encoding,sharedLayouts);
+        if (debugWriter.write(debugPathFor(file)) == WriteResult::FAILED)
+        {
+            std::cerr<< "Unable to write to file "<<debugPathFor(file)<<"\n";
+            return false;
+        }
+        stats.written.insert(debugPathFor(file).lexically_normal());
+    }
+    if (state.stripDebugInfo)
+    {
+        stripShaderCode(pending.fileData,relativeName,stats.sizes);
+    }
+    ProfileScope writeScope(state.profiler.get(),"write",relativeName,file.generic_string());
+    ShaderFileWriter writer(pending.fileData,state.format,state.encoding,sharedLayouts);
+    if (writer.write(file) == WriteResult::FAILED)
+    {
+        std::cerr<< "Unable to write to file "<<file<<"\n";
+        return false;
+    }
+    ++stats.fileCount;
+    stats.duplicateBytes += writer.duplicateBytes();
+    return true;
 }
-std::vector<std::string> getCallableParameters(FunctionReflection* reflection)
+
+void reportProfile(BuildState& state)
 {
-    return std::vector<std::string>();
+    if (!state.profiler)
+    {
+        return;
+    }
+    //watch mode keeps adding to the same profile, the trace covers every build so far
+    if (!state.profileFile.empty() && !state.profiler->writeTrace(state.profileFile))
+    {
+        std::cerr<< "Unable to write profile "<<state.profileFile<<"\n";
+    }
+    if (state.profileSummary > 0)
+    {
+        state.profiler->printSummary(std::cout,state.profileSummary);
+    }
 }
-std::vector<std::string> getMeshParameters(FunctionReflection* reflection)
+
+std::filesystem::path outputPathFor(const std::filesystem::path& modulePath)
 {
-    return std::vector<std::string>();
+    return std::filesystem::path(modulePath).replace_extension(".cshdr");
 }
-std::vector<std::string> getAmplificationParameters(FunctionReflection* reflection)
+
+std::filesystem::path debugPathFor(const std::filesystem::path& outputPath)
 {
-    return std::vector<std::string>();
+    auto path = outputPath;
+    return path += ".dbg";
 }
 
-bool isValidColorTarget(const std::string& colorTarget)
+void stripShaderCode(ShaderFileData& fileData, const std::string& file, std::vector<StageSize>& sizes)
 {
-    if( colorTarget == "R32G32B32A32_FLOAT"){return true;}
-    else if( colorTarget == "R32G32B32A32_UINT"){return true;}
-    else if( colorTarget == "R32G32B32A32_SINT"){return true;}
-    else if( colorTarget == "R32G32B32_FLOAT"){return true;}
-    else if( colorTarget == "R32G32B32_UINT"){return true;}
-    else if( colorTarget == "R32G32B32_SINT"){return true;}
-    else if( colorTarget == "R16G16B16A16_FLOAT"){return true;}
-    else if( colorTarget == "R16G16B16A16_UNORM"){return true;}
-    else if( colorTarget == "R16G16B16A16_UINT"){return true;}
-    else if( colorTarget == "R16G16B16A16_SNORM"){return true;}
-    else if( colorTarget == "R16G16B16A16_SINT"){return true;}
-    else if( colorTarget == "R32G32_FLOAT"){return true;}
-    else if( colorTarget == "R32G32_UINT"){return true;}
-    else if( colorTarget == "R32G32_SINT"){return true;}
-    else if( colorTarget == "R10G10B10A2_UNORM"){return true;}
-    else if( colorTarget == "R10G10B10A2_UINT"){return true;}
-    else if( colorTarget == "R11G11B10_FLOAT"){return true;}
-    else if( colorTarget == "R8G8B8A8_UNORM"){return true;}
-    else if( colorTarget == "R8G8B8A8_UNORM_SRGB"){return true;}
-    else if( colorTarget == "R8G8B8A8_UINT"){return true;}
-    else if( colorTarget == "R8G8B8A8_SNORM"){return true;}
-    else if( colorTarget == "R8G8B8A8_SINT"){return true;}
-    else if( colorTarget == "R16G16_FLOAT"){return true;}
-    else if( colorTarget == "R16G16_UNORM"){return true;}
-    else if( colorTarget == "R16G16_UINT"){return true;}
-    else if( colorTarget == "R16G16_SNORM"){return true;}
-    else if( colorTarget == "R16G16_SINT"){return true;}
-    else if( colorTarget == "R32_FLOAT"){return true;}
-    else if( colorTarget == "R32_UINT"){return true;}
-    else if( colorTarget == "R32_SINT"){return true;}
-    else if( colorTarget == "R8G8_UNORM"){return true;}
-    else if( colorTarget == "R8G8_UINT"){return true;}
-    else if( colorTarget == "R8G8_SNORM"){return true;}
-    else if( colorTarget == "R8G8_SINT"){return true;}
-    else if( colorTarget == "R16_FLOAT"){return true;}
-    else if( colorTarget == "R16_UNORM"){return true;}
-    else if( colorTarget == "R16_UINT"){return true;}
-    else if( colorTarget == "R16_SNORM"){return true;}
-    else if( colorTarget == "R16_SINT"){return true;}
-    else if( colorTarget == "R8_UNORM"){return true;}
-    else if( colorTarget == "R8_UINT"){return true;}
-    else if( colorTarget == "R8_SNORM"){return true;}
-    else if( colorTarget == "R8_SINT"){return true;}
-    else if( colorTarget == "A8_UNORM"){return true;}
-    else if( colorTarget == "R9G9B9E5_SHAREDEXP"){return true;}
-    else if( colorTarget == "R8G8_B8G8_UNORM"){return true;}
-    else if( colorTarget == "G8R8_G8B8_UNORM"){return true;}
-    else if( colorTarget == "BC1_UNORM"){return true;}
-    else if( colorTarget == "BC1_UNORM_SRGB"){return true;}
-    else if( colorTarget == "BC2_UNORM"){return true;}
-    else if( colorTarget == "BC2_UNORM_SRGB"){return true;}
-    else if( colorTarget == "BC3_UNORM"){return true;}
-    else if( colorTarget == "BC3_UNORM_SRGB"){return true;}
-    else if( colorTarget == "BC4_UNORM"){return true;}
-    else if( colorTarget == "BC4_SNORM"){return true;}
-    else if( colorTarget == "BC5_UNORM"){return true;}
-    else if( colorTarget == "BC5_SNORM"){return true;}
-    else if( colorTarget == "B5G6R5_UNORM"){return true;}
-    else if( colorTarget == "B5G5R5A1_UNORM"){return true;}
-    else if( colorTarget == "B8G8R8A8_UNORM"){return true;}
-    else if( colorTarget == "B8G8R8X8_UNORM"){return true;}
-    else if( colorTarget == "B8G8R8A8_UNORM_SRGB"){return true;}
-    else if( colorTarget == "B8G8R8X8_UNORM_SRGB"){return true;}
-    else if( colorTarget == "BC6H_UF16"){return true;}
-    else if( colorTarget == "BC6H_SF16"){return true;}
-    else if( colorTarget == "BC7_UNORM"){return true;}
-    else if( colorTarget == "BC7_UNORM_SRGB"){return true;}
-    else if( colorTarget == "AYUV"){return true;}
-    else if( colorTarget == "NV12"){return true;}
-    else if( colorTarget == "OPAQUE_420"){return true;}
-    else if( colorTarget == "YUY2"){return true;}
-    else if( colorTarget == "B4G4R4A4_UNORM"){return true;}
-    return false;
-
+    //stages of a shared module point at one blob, which gets a single row naming every stage using it
+    std::map<IBlob*,size_t> rows;
+    std::vector<size_t> stageRows;
+    for (auto& outData: fileData.shaderOutData)
+    {
+        auto [row,added] = rows.emplace(outData.spirvCode.get(),sizes.size());
+        if (added)
+        {
+            sizes.push_back({.file = file,.stage = outData.stage,.compiled = outData.spirvCode->getBufferSize()});
+        }
+        else
+        {
+            sizes[row->second].stage += "," + outData.stage;
+        }
+        stageRows.push_back(row->second);
+    }
+    stripFileCode(fileData);
+    for (auto i=0; i<fileData.shaderOutData.size(); ++i)
+    {
+        sizes[stageRows[i]].shipped = fileData.shaderOutData[i].spirvCode->getBufferSize();
+    }
 }
 
-bool isValidDepthTarget(const std::string & depthTarget)
+void printSizeTable(std::vector<StageSize>& sizes)
 {
-    if( depthTarget == "D32_FLOAT_S8X24_UINT"){return true;}
-    else if( depthTarget == "D32_FLOAT"){return true;}
-    else if( depthTarget == "D24_UNORM_S8_UINT"){return true;}
-    else if( depthTarget == "D16_UNORM"){return true;}
-    else if( depthTarget == "none"){return true;}
-    return false;
+    std::sort(sizes.begin(),sizes.end(),[](const StageSize& a, const StageSize& b){return std::tie(a.file,a.stage) < std::tie(b.file,b.stage);});
+    size_t fileWidth = 6;
+    for (auto& size: sizes)
+    {
+        fileWidth = std::max(fileWidth,size.file.size());
+    }
+    size_t compiled = 0;
+    size_t shipped = 0;
+    auto printRow = [&](const std::string& file, const std::string& stage, size_t before, size_t after)
+    {
+        std::cout << std::left<<std::setw(fileWidth + 2)<<file<<std::setw(14)<<stage
+                  <<std::right<<std::setw(12)<<before<<std::setw(12)<<after
+                  <<std::setw(8)<<std::fixed<<std::setprecision(1)<<(before ? 100.0*(before - after)/before : 0.0)<<"%\n";
+    };
+    std::cout << std::left<<std::setw(fileWidth + 2)<<"Shader"<<std::setw(14)<<"Stage"
+              <<std::right<<std::setw(12)<<"Compiled"<<std::setw(12)<<"Shipped"<<std::setw(9)<<"Saved"<<"\n";
+    for (auto& size: sizes)
+    {
+        printRow(size.file,size.stage,size.compiled,size.shipped);
+        compiled += size.compiled;
+        shipped += size.shipped;
+    }
+    printRow("Total","",compiled,shipped);
 }
-
@@ -0,0 +1,96 @@
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "BuildManifest.h"
+#include "FileWatcher.h"
+#include "ShaderFileWriter.h"
+
+bool writeText(const std::filesystem::path& file, const char* text);
+
+///Writes everything a watch mode build writes into a root folder the watcher covers, then edits a module. Only the module
+///may be reported, anything else would start the next build and watch mode would never settle
+int main()
+{
+    auto root = std::filesystem::temp_directory_path()/"shaderfax-watch-test";
+    std::error_code error;
+    std::filesystem::remove_all(root,error);
+    std::filesystem::create_directories(root/"shaders");
+    auto module = root/"shaders"/"lit.slang";
+    auto output = root/"output";
+    auto cache = root/"cache";
+    if (!writeText(module,"[shader(\"vertex\")] float4 main() : SV_Position { return 0; }\n"))
+    {
+        std::cerr << "Unable to write "<<module<<"\n";
+        return EXIT_FAILURE;
+    }
+
+    FileWatcher watcher(root);
+    if (!watcher.isValid())
+    {
+        //file watching is only implemented on Linux
+        std::cout << "File watching isn't available, skipped\n";
+        return 0;
+    }
+    auto manifestFile = BuildManifest::manifestPathFor(output);
+    for (auto& path: {output,manifestFile,root/"shaders.shpak",root/"layouts.sflt",root/"graph.json",root/"profile.json",cache})
+    {
+        watcher.ignore(path);
+    }
+
+    std::filesystem::create_directories(output/"shaders");
+    std::filesystem::create_directories(cache/"ab");
+    ShaderFileData fileData;
+    ShaderFileWriter writer(fileData);
+    BuildManifest manifest(0);
+    bool written = writer.write(output/"shaders"/"lit.cshdr") != WriteResult::FAILED && writer.write(output/"shaders"/"lit.cshdr.dbg") != WriteResult::FAILED
+                   && writer.write(root/"shaders.shpak") != WriteResult::FAILED && writer.write(root/"layouts.sflt") != WriteResult::FAILED
+                   && manifest.save(manifestFile) && writeText(root/"graph.json","{}") && writeText(root/"profile.json","[]")
+                   && writeText(cache/"ab"/"abcdef.entry.1234.tmp","");
+    std::filesystem::rename(cache/"ab"/"abcdef.entry.1234.tmp",cache/"ab"/"abcdef.entry",error);
+    if (!written || error)
+    {
+        std::cerr << "Unable to write the build outputs under "<<root<<"\n";
+        return EXIT_FAILURE;
+    }
+    //the edit ends the wait, everything written before it was queued already
+    if (!writeText(module,"[shader(\"vertex\")] float4 main() : SV_Position { return 1; }\n"))
+    {
+        std::cerr << "Unable to write "<<module<<"\n";
+        return EXIT_FAILURE;
+    }
+
+    std::vector<std::filesystem::path> changed;
+    if (!watcher.waitForChanges(changed,std::chrono::milliseconds(50)))
+    {
+        std::cerr << "Watching "<<root<<" failed\n";
+        return EXIT_FAILURE;
+    }
+    int failures = 0;
+    for (auto& file: changed)
+    {
+        if (file.lexically_normal() != module.lexically_normal())
+        {
+            std::cerr << "The watcher reported "<<file<<", which the build wrote itself\n";
+            ++failures;
+        }
+    }
+    if (changed.empty())
+    {
+        std::cerr << "The watcher didn't report the edited module\n";
+        ++failures;
+    }
+    std::filesystem::remove_all(root,error);
+    return failures == 0 ? 0 : EXIT_FAILURE;
+}
+
+bool writeText(const std::filesystem::path& file, const char* text)
+{
+    std::ofstream outFile(file, std::ios::trunc);
+    outFile << text;
+    outFile.close();
+    return (bool)outFile;
+}